@@ -153,10 +153,21 @@ class Graphics2dManager(System):
     def draw_vector(self, v:Vec2f, origin_pos:Vec2f, color:Color):
         pass
 
+class Prefab:
+    def __init__(self):
+        self.name = ""
+
+
 class SceneManager(System):
     def load_scene(self, scene_name):
         pass
 
+    def load_prefab(self, prefab_path) -> Prefab:
+        pass
+
+    def instantiate_prefab(self, prefab: Prefab, count) -> list:
+        pass
+
 
 class Transform2dManager(System, ComponentManager):
     pass
@@ -181,6 +192,17 @@ class EntityManager(System):
     def get_entities_with_type(self, componentType):
         pass
 
+    def get_query(self, component_types) -> 'EntityQuery':
+        pass
+
+
+class EntityQuery:
+    def __len__(self):
+        return 0
+
+    def __iter__(self):
+        return iter([])
+
 
 class Body2dManager(System, ComponentManager):
     pass
@@ -197,6 +219,7 @@ class Configuration:
 class Engine:
     def __init__(self):
         self.config = Configuration()
+        self.running = True
 
 
 class Component:
@@ -215,6 +238,13 @@ class Transform2d():
         self.euler_angle = 0.0
 
 
+class Transform2dRef(Transform2d):
+    """Transform of an entity returned by the Transform2dManager, the changes are written to the manager"""
+    def __init__(self):
+        super().__init__()
+        self.entity = 0
+
+
 class Sound:
     def play(self):
         pass
@@ -28,12 +28,11 @@ SOFTWARE.
 #include <SFML/Graphics/VertexArray.hpp>
 #include <Box2D/Common/b2Math.h>
 #include <graphics/graphics2d.h>
+#include <engine/transform2d.h>
 
 
 namespace sfge
 {
-struct Transform2d;
-class Transform2dManager;
 class Body2dManager;
 class TextureManager;
 class SpriteManager;
@@ -61,7 +60,15 @@ public:
 
 private:
 
-  	void UpdateRange(int startIndex, int endIndex);
+  	void UpdateRange(int startIndex, int endIndex, float* positionsX, float* positionsY);
+#ifndef WITH_PHYSICS
+	/**
+	 * \brief Check that the planets still follow each other in the arrays of the transforms, from m_FirstSoAIndex
+	 */
+	bool ArePlanetsPacked(const Transform2dSoA& transforms) const;
+	void ReadPositions(size_t startIndex, size_t endIndex);
+	void WritePositions(size_t startIndex, size_t endIndex);
+#endif
 	b2Vec2 CalculateInitSpeed(sf::Vector2f position) const;
 	b2Vec2 CalculateNewForce(sf::Vector2f position) const;
 	static float Magnitude(sf::Vector2f v);
@@ -79,7 +86,19 @@ private:
 	const size_t entitiesNmb = 10'000;
 
 #ifndef WITH_PHYSICS
-	std::vector<Vec2f> m_Velocities{entitiesNmb};
+	std::vector<Entity> m_Planets;
+	/**
+	 * \brief Index of the first planet in the transform arrays of the manager with Configuration::transformSoA,
+	 * the planets are created one after the other so the kernels move them in place
+	 */
+	size_t m_FirstSoAIndex = Transform2dManager::INVALID_SOA_INDEX;
+	/**
+	 * \brief Copy of the positions when the manager stores Transform2d structs, read and written back at each fixed update
+	 */
+	std::vector<float> m_PositionsX;
+	std::vector<float> m_PositionsY;
+	std::vector<float> m_VelocitiesX;
+	std::vector<float> m_VelocitiesY;
 #endif
 
 	sf::Vector2f screenSize;
@@ -89,12 +108,6 @@ private:
 	sf::Texture* texture = nullptr;
 	sf::Vector2f textureSize;
 #endif
-#ifdef MULTI_THREAD
-
-	  std::vector<Vec2f> m_Positions{entitiesNmb};
-
-#endif
-
 };
 
 
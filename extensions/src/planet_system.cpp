@@ -22,6 +22,8 @@ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
 SOFTWARE.
 */
 
+#include <algorithm>
+
 #include <extensions/planet_system.h>
 #include <engine/engine.h>
 #include <engine/config.h>
@@ -61,43 +63,55 @@ void PlanetSystem::OnEngineInit()
 	const auto textureId = m_TextureManager->LoadTexture("data/sprites/round.png");
 	texture = m_TextureManager->GetTexture(textureId);
 	textureSize = sf::Vector2f(texture->getSize().x, texture->getSize().y);
+#else
+	//All the planets share the same texture, looked up once
+	const std::string texturePath = "data/sprites/round.png";
+	const auto textureId = m_TextureManager->LoadTexture(texturePath);
+	const auto texture = m_TextureManager->GetTexture(textureId);
 #endif
 
+#ifndef WITH_PHYSICS
+	m_Planets.clear();
+	m_Planets.reserve(entitiesNmb);
+	m_PositionsX.resize(entitiesNmb);
+	m_PositionsY.resize(entitiesNmb);
+	m_VelocitiesX.resize(entitiesNmb);
+	m_VelocitiesY.resize(entitiesNmb);
+	if (auto* transforms = m_Transform2DManager->GetSoA())
+	{
+		transforms->Reserve(transforms->Size() + entitiesNmb);
+	}
+#endif
 	for (auto i = 0u; i < entitiesNmb; i++)
 	{
 		const auto newEntity = entityManager->CreateEntity(i + 1);
 
-#ifdef MULTI_THREAD
-		m_Positions[i] = sf::Vector2f(std::rand() % static_cast<int>(screenSize.x), std::rand() % static_cast<int>(screenSize.y));
-#else
-		auto transformPtr = m_Transform2DManager->AddComponent(newEntity);
-		transformPtr->Position = sf::Vector2f(std::rand() % static_cast<int>(screenSize.x), std::rand() % static_cast<int>(screenSize.y));
-#endif
+		const auto position = sf::Vector2f(std::rand() % static_cast<int>(screenSize.x), std::rand() % static_cast<int>(screenSize.y));
+		m_Transform2DManager->AddComponent(newEntity);
+		m_Transform2DManager->GetComponentRef(newEntity).SetPosition(position);
 #ifdef WITH_PHYSICS
 		auto body = m_Body2DManager->AddComponent(newEntity);
-		body->SetLinearVelocity(CalculateInitSpeed(transformPtr->Position));
-#else
-#ifndef MULTI_THREAD
-		m_Velocities[i] = meter2pixel(CalculateInitSpeed(transformPtr->Position));
+		body->SetLinearVelocity(CalculateInitSpeed(position));
 #else
-
-		m_Velocities[i] = meter2pixel(CalculateInitSpeed(m_Positions[i]));
-#endif
+		m_Planets.push_back(newEntity);
+		m_PositionsX[i] = position.x;
+		m_PositionsY[i] = position.y;
+		const auto velocity = meter2pixel(CalculateInitSpeed(position));
+		m_VelocitiesX[i] = velocity.x;
+		m_VelocitiesY[i] = velocity.y;
 #endif
 		
 #ifndef WITH_VERTEXARRAY
-		std::string texturePath = "data/sprites/round.png";
-		const auto textureId = m_TextureManager->LoadTexture(texturePath);
-		const auto texture = m_TextureManager->GetTexture(textureId);
-
 		auto sprite = m_SpriteManager->AddComponent(newEntity);
 		sprite->SetTexture(texture);
 
-		auto& spriteInfo = m_SpriteManager->GetComponentInfo(newEntity);
-		spriteInfo.name = "Sprite";
-		spriteInfo.sprite = sprite;
-		spriteInfo.textureId = textureId;
-		spriteInfo.texturePath = texturePath;
+		if (auto* spriteInfo = m_SpriteManager->GetComponentInfo(newEntity))
+		{
+			spriteInfo->name = "Sprite";
+			spriteInfo->sprite = sprite;
+			spriteInfo->textureId = textureId;
+			spriteInfo->texturePath = texturePath;
+		}
 #else
 		m_VertexArray[4 * i].texCoords = sf::Vector2f(0, 0);
 		m_VertexArray[4 * i + 1].texCoords = sf::Vector2f(textureSize.x, 0);
@@ -106,6 +120,12 @@ void PlanetSystem::OnEngineInit()
 #endif
 
 	}
+#ifndef WITH_PHYSICS
+	if (!m_Planets.empty())
+	{
+		m_FirstSoAIndex = m_Transform2DManager->GetSoAIndex(m_Planets.front());
+	}
+#endif
 }
 
 void PlanetSystem::OnUpdate(float dt)
@@ -113,76 +133,112 @@ void PlanetSystem::OnUpdate(float dt)
 	(void) dt;
 }
 
-void PlanetSystem::UpdateRange(int startIndex, int endIndex)
+void PlanetSystem::UpdateRange(int startIndex, int endIndex, float* positionsX, float* positionsY)
 {
-#ifdef MULTI_THREAD
+#ifndef WITH_PHYSICS
 	for(int i = startIndex; i < endIndex; i++)
 	{
-
-		const auto force = meter2pixel(CalculateNewForce(m_Positions[i]));
-		m_Velocities[i] += force / planetMass * fixedDeltaTime;
-		m_Positions[i] += m_Velocities[i] * fixedDeltaTime;
-		const auto pos = m_Positions[i];
+		const auto force = meter2pixel(CalculateNewForce(sf::Vector2f(positionsX[i], positionsY[i])));
+		m_VelocitiesX[i] += force.x / planetMass * fixedDeltaTime;
+		m_VelocitiesY[i] += force.y / planetMass * fixedDeltaTime;
+	}
+	IntegratePositions(positionsX + startIndex, positionsY + startIndex,
+		m_VelocitiesX.data() + startIndex, m_VelocitiesY.data() + startIndex, endIndex - startIndex, fixedDeltaTime);
+#ifdef WITH_VERTEXARRAY
+	for(int i = startIndex; i < endIndex; i++)
+	{
+		const auto pos = sf::Vector2f(positionsX[i], positionsY[i]);
 
 		m_VertexArray[4 * i].position = pos - textureSize / 2.0f;
 		m_VertexArray[4 * i + 1].position = pos + sf::Vector2f(textureSize.x / 2.0f, -textureSize.y / 2.0f);
 		m_VertexArray[4 * i + 2].position = pos + textureSize / 2.0f;
 		m_VertexArray[4 * i + 3].position = pos + sf::Vector2f(-textureSize.x / 2.0f, textureSize.y / 2.0f);
 	}
+#endif
 #else
 	(void) startIndex;
 	(void) endIndex;
+	(void) positionsX;
+	(void) positionsY;
 #endif
 }
 
-void PlanetSystem::OnFixedUpdate()
+#ifndef WITH_PHYSICS
+bool PlanetSystem::ArePlanetsPacked(const Transform2dSoA& transforms) const
 {
-	rmt_ScopedCPUSample(PlanetSystemFixedUpdate,0);
-#ifdef MULTI_THREAD
-	auto& threadPool = m_Engine.GetThreadPool();
-	const auto coreNmb = threadPool.size();
+	const auto& entities = transforms.GetEntities();
+	return m_FirstSoAIndex != Transform2dManager::INVALID_SOA_INDEX &&
+		m_FirstSoAIndex + m_Planets.size() <= entities.size() &&
+		std::equal(m_Planets.begin(), m_Planets.end(), entities.begin() + m_FirstSoAIndex);
+}
 
-	std::vector<std::future<void>> joinFutures(coreNmb);
-	for(int threadIndex = 0; threadIndex < coreNmb;threadIndex++)
+void PlanetSystem::ReadPositions(size_t startIndex, size_t endIndex)
+{
+	for (auto i = startIndex; i < endIndex; i++)
 	{
-		int start = (threadIndex + 1)*entitiesNmb/ (coreNmb + 1);
-		int end = (threadIndex + 2)*entitiesNmb / (coreNmb + 1)-1;
-		auto worldUpdateFunction = std::bind(&PlanetSystem::UpdateRange, this, start, end);
-		joinFutures[threadIndex] = threadPool.push(worldUpdateFunction);
+		const auto position = m_Transform2DManager->GetLocalTransform(m_Planets[i]).Position;
+		m_PositionsX[i] = position.x;
+		m_PositionsY[i] = position.y;
 	}
-	UpdateRange(0, entitiesNmb / (coreNmb + 1) - 1);
-	for(int i = 0; i < coreNmb;i++)
+}
+
+void PlanetSystem::WritePositions(size_t startIndex, size_t endIndex)
+{
+	for (auto i = startIndex; i < endIndex; i++)
 	{
-		joinFutures[i].get();
+		m_Transform2DManager->GetComponentRef(m_Planets[i]).SetPosition(sf::Vector2f(m_PositionsX[i], m_PositionsY[i]));
 	}
-#else
-	for(auto i = 0u; i < entitiesNmb ; i++)
-	{
+}
+#endif
 
+void PlanetSystem::OnFixedUpdate()
+{
+	rmt_ScopedCPUSample(PlanetSystemFixedUpdate,0);
 #ifdef WITH_PHYSICS
-		const auto transformPtr = m_Engine.GetTransform2dManager()->GetComponentPtr(i + 1);
-		auto bodyPtr = m_Engine.GetPhysicsManager()->GetBodyManager()->GetComponentPtr(i + 1);
-		bodyPtr->ApplyForce(CalculateNewForce(transformPtr->Position));
-#else
-		auto transformPtr = m_Engine.GetTransform2dManager()->GetComponentPtr(i + 1);
-		const auto force = meter2pixel(CalculateNewForce(transformPtr->Position));
-
-		m_Velocities[i] += force / planetMass * fixedDeltaTime;
-		transformPtr->Position += m_Velocities[i] * fixedDeltaTime;
-#endif
+	auto* entityManager = m_Engine.GetEntityManager();
+	for(auto i = 0u; i < entitiesNmb ; i++)
+	{
+		const auto entity = entityManager->GetEntityByIndex(i);
+		if (entity == INVALID_ENTITY)
+		{
+			continue;
+		}
+		const sf::Vector2f pos = m_Transform2DManager->GetLocalTransform(entity).Position;
+		auto bodyPtr = m_Engine.GetPhysicsManager()->GetBodyManager()->GetComponentPtr(entity);
+		bodyPtr->ApplyForce(CalculateNewForce(pos));
 #ifdef WITH_VERTEXARRAY
-		const auto pos = transformPtr->Position;
 
 		m_VertexArray[4 * i].position = pos - textureSize / 2.0f;
 		m_VertexArray[4 * i + 1].position = pos + sf::Vector2f(textureSize.x / 2.0f, -textureSize.y / 2.0f);
 		m_VertexArray[4 * i + 2].position = pos + textureSize / 2.0f;
 		m_VertexArray[4 * i + 3].position = pos + sf::Vector2f(-textureSize.x / 2.0f, textureSize.y / 2.0f);
-
-
 #endif
 	}
+#else
+	//With the transform arrays, the kernels move the planets in place.
+	//Otherwise the positions are copied from the transforms, as the editor or a restored snapshot can move them, then written back
+	auto* transforms = m_Transform2DManager->GetSoA();
+	const bool inPlace = transforms != nullptr && ArePlanetsPacked(*transforms);
+	auto* positionsX = inPlace ? transforms->positionsX.data() + m_FirstSoAIndex : m_PositionsX.data();
+	auto* positionsY = inPlace ? transforms->positionsY.data() + m_FirstSoAIndex : m_PositionsY.data();
+	const auto updateRange = [this, inPlace, positionsX, positionsY](size_t start, size_t end)
+	{
+		if (!inPlace)
+		{
+			ReadPositions(start, end);
+		}
+		UpdateRange(static_cast<int>(start), static_cast<int>(end), positionsX, positionsY);
+		if (!inPlace)
+		{
+			WritePositions(start, end);
+		}
+	};
+#ifdef MULTI_THREAD
+	m_Engine.GetJobSystem().ParallelFor(0, m_Planets.size(), 256, updateRange);
+#else
+	updateRange(0, m_Planets.size());
+#endif
 #endif
-
 }
 
 void PlanetSystem::OnDraw()
@@ -134,5 +134,7 @@ protected:
 	int GetFreeComponentIndex() override;
 	SoundBufferManager* m_SoundBufferManager = nullptr;
 };
+
+SFGE_COMPONENT_TRAITS(Sound, SoundManager, ComponentType::SOUND)
 }
 #endif
\ No newline at end of file
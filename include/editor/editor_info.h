@@ -23,13 +23,14 @@ SOFTWARE.
 */
 #ifndef SFGE_EDITOR_INFO_H
 #define SFGE_EDITOR_INFO_H
+#include <cstdint>
 #include <string>
 #include <engine/globals.h>
 
 namespace sfge
 {
 class Engine;
-enum class ComponentType : int;
+enum class ComponentType : std::uint64_t;
 }
 //Editor components
 namespace sfge::editor
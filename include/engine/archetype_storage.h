@@ -0,0 +1,253 @@
+/*
+MIT License
+
+Copyright (c) 2017 SAE Institute Switzerland AG
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef SFGE_ARCHETYPE_STORAGE_H
+#define SFGE_ARCHETYPE_STORAGE_H
+
+#include <array>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <engine/entity.h>
+#include <engine/job_system.h>
+
+namespace sfge
+{
+
+const size_t ARCHETYPE_CHUNK_SIZE = 16 * 1024;
+const size_t MAX_ARCHETYPE_COMPONENT_TYPES = sizeof(EntityMask) * 8;
+
+/**
+ * \brief How to construct, move and destroy a component stored in the raw memory of a chunk
+ */
+struct ArchetypeComponentType
+{
+	size_t size = 0;
+	size_t alignment = 1;
+	void (*construct)(void* dst) = nullptr;
+	void (*moveConstruct)(void* dst, void* src) = nullptr;
+	void (*destroy)(void* component) = nullptr;
+};
+
+/**
+ * \brief Rows of a chunk, the entities and each component type are stored in their own column
+ */
+struct ArchetypeChunkView
+{
+	const Entity* entities = nullptr;
+	size_t count = 0;
+	std::array<unsigned char*, MAX_ARCHETYPE_COMPONENT_TYPES> columns{};
+
+	template<typename T>
+	T* GetColumn(int componentTypeIndex) const
+	{
+		return reinterpret_cast<T*>(columns[componentTypeIndex]);
+	}
+};
+
+/**
+ * \brief Entities sharing the same set of component types are stored together in 16 KB chunks,
+ * so a query over several component types reads each column linearly
+ */
+class ArchetypeStorage
+{
+public:
+	ArchetypeStorage() = default;
+	~ArchetypeStorage();
+	ArchetypeStorage(const ArchetypeStorage&) = delete;
+	ArchetypeStorage& operator=(const ArchetypeStorage&) = delete;
+
+	template<typename T>
+	void RegisterComponentType(int componentTypeIndex);
+	bool IsComponentTypeRegistered(int componentTypeIndex) const;
+
+	/**
+	 * \brief Move the entity to the archetype including the component type, the new component is default constructed
+	 * \return The component of the entity, pointers to its other components are invalidated when it moves.
+	 * nullptr when another handle with the same index owns the row, like for an outdated handle
+	 */
+	void* AddComponent(Entity entity, int componentTypeIndex);
+	void RemoveComponent(Entity entity, int componentTypeIndex);
+	void RemoveEntity(Entity entity);
+	/**
+	 * \return The component of the entity or nullptr when it has none
+	 */
+	void* GetComponent(Entity entity, int componentTypeIndex) const;
+	bool HasComponent(Entity entity, int componentTypeIndex) const;
+	size_t GetComponentNmb(int componentTypeIndex) const;
+	/**
+	 * \brief Remove this component type from every entity
+	 */
+	void ClearComponentType(int componentTypeIndex);
+	void Clear();
+
+	/**
+	 * \brief Call function on each chunk whose archetype includes all the component types of the mask
+	 */
+	template<typename F>
+	void ForEachChunk(EntityMask mask, const F& function) const;
+	/**
+	 * \brief ForEachChunk split between the workers, the chunks of all the matching archetypes are numbered
+	 * in one range so nothing is allocated per call
+	 */
+	template<typename F>
+	void ParallelForEachChunk(JobSystem& jobSystem, EntityMask mask, const F& function) const;
+
+	size_t GetArchetypeNmb() const;
+private:
+	static const unsigned INVALID_ARCHETYPE = ~0u;
+	struct Chunk
+	{
+		alignas(CACHE_LINE_SIZE) unsigned char data[ARCHETYPE_CHUNK_SIZE];
+	};
+	struct Archetype
+	{
+		EntityMask mask = 0;
+		std::vector<int> componentTypeIndexes;
+		std::array<size_t, MAX_ARCHETYPE_COMPONENT_TYPES> columnOffsets{};
+		size_t chunkCapacity = 0;
+		size_t count = 0;
+		std::vector<std::unique_ptr<Chunk>> chunks;
+
+		unsigned char* GetComponent(size_t row, int componentTypeIndex, size_t componentSize) const;
+		Entity& GetEntity(size_t row) const;
+		size_t GetChunkNmb() const { return (count + chunkCapacity - 1) / chunkCapacity; }
+	};
+	struct EntityLocation
+	{
+		unsigned archetype = INVALID_ARCHETYPE;
+		size_t row = 0;
+	};
+
+	unsigned GetOrCreateArchetype(EntityMask mask);
+	/**
+	 * \brief Append a row in the archetype, its components are not constructed
+	 */
+	size_t AllocateRow(Archetype& archetype, Entity entity);
+	/**
+	 * \brief Destroy the components of the row and move the last row in its place
+	 */
+	void FreeRow(Archetype& archetype, size_t row);
+	void MoveEntity(Entity entity, EntityMask newMask);
+	EntityLocation& GetLocation(Entity entity);
+	ArchetypeChunkView GetChunkView(const Archetype& archetype, size_t chunkIndex) const;
+
+	std::array<ArchetypeComponentType, MAX_ARCHETYPE_COMPONENT_TYPES> m_ComponentTypes{};
+	std::vector<std::unique_ptr<Archetype>> m_Archetypes;
+	std::unordered_map<EntityMask, unsigned> m_ArchetypeIndexes;
+	std::vector<EntityLocation> m_EntityLocations;
+};
+
+template <typename T>
+void ArchetypeStorage::RegisterComponentType(int componentTypeIndex)
+{
+	static_assert(alignof(T) <= CACHE_LINE_SIZE, "Archetype columns are aligned on cache lines");
+	auto& componentType = m_ComponentTypes[componentTypeIndex];
+	componentType.size = sizeof(T);
+	componentType.alignment = alignof(T);
+	componentType.construct = [](void* dst)
+	{
+		new (dst) T();
+	};
+	componentType.moveConstruct = [](void* dst, void* src)
+	{
+		new (dst) T(std::move(*static_cast<T*>(src)));
+	};
+	componentType.destroy = [](void* component)
+	{
+		static_cast<T*>(component)->~T();
+	};
+}
+
+template <typename F>
+void ArchetypeStorage::ForEachChunk(EntityMask mask, const F& function) const
+{
+	for (const auto& archetype : m_Archetypes)
+	{
+		if ((archetype->mask & mask) != mask)
+		{
+			continue;
+		}
+		for (size_t chunkIndex = 0; chunkIndex * archetype->chunkCapacity < archetype->count; chunkIndex++)
+		{
+			function(GetChunkView(*archetype, chunkIndex));
+		}
+	}
+}
+
+template <typename F>
+void ArchetypeStorage::ParallelForEachChunk(JobSystem& jobSystem, EntityMask mask, const F& function) const
+{
+	size_t chunkNmb = 0;
+	for (const auto& archetype : m_Archetypes)
+	{
+		if ((archetype->mask & mask) == mask)
+		{
+			chunkNmb += archetype->GetChunkNmb();
+		}
+	}
+	jobSystem.ParallelFor(0, chunkNmb, 1, [this, mask, &function](size_t start, size_t end)
+	{
+		//Find the archetype of the first chunk of the range, then walk the chunks in order
+		size_t archetypeIndex = 0;
+		size_t chunkIndex = start;
+		for (; archetypeIndex < m_Archetypes.size(); archetypeIndex++)
+		{
+			const auto& archetype = *m_Archetypes[archetypeIndex];
+			if ((archetype.mask & mask) != mask)
+			{
+				continue;
+			}
+			if (chunkIndex < archetype.GetChunkNmb())
+			{
+				break;
+			}
+			chunkIndex -= archetype.GetChunkNmb();
+		}
+		for (auto i = start; i < end && archetypeIndex < m_Archetypes.size(); i++)
+		{
+			const auto& archetype = *m_Archetypes[archetypeIndex];
+			function(GetChunkView(archetype, chunkIndex));
+			chunkIndex++;
+			if (chunkIndex < archetype.GetChunkNmb())
+			{
+				continue;
+			}
+			chunkIndex = 0;
+			archetypeIndex++;
+			while (archetypeIndex < m_Archetypes.size() &&
+				((m_Archetypes[archetypeIndex]->mask & mask) != mask || m_Archetypes[archetypeIndex]->count == 0))
+			{
+				archetypeIndex++;
+			}
+		}
+	});
+}
+
+}
+#endif
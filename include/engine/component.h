@@ -27,10 +27,13 @@ SOFTWARE.
 #define SFGE_COMPONENT_H
 
 #include <queue>
+#include <sstream>
 #include <vector>
 #include <any>
 
 #include <engine/globals.h>
+#include <engine/component_storage.h>
+#include <engine/paged_vector.h>
 #include <utility/log.h>
 #include <engine/entity.h>
 #include <engine/system.h>
@@ -45,7 +48,7 @@ SOFTWARE.
 namespace sfge
 {
 
-enum class ComponentType : int
+enum class ComponentType : std::uint64_t
 {
   	NONE = 0,
 	TRANSFORM2D = 1 << 0,
@@ -58,13 +61,72 @@ enum class ComponentType : int
 	ANIMATION2D = 1 << 7
 };
 
+/**
+ * \brief Number of component types, their indexes are dense between 0 and COMPONENT_TYPE_NMB
+ */
+constexpr int COMPONENT_TYPE_NMB = 8;
+
+/**
+ * \brief Index of the component type bit in the entity mask
+ */
+constexpr int GetComponentTypeIndex(ComponentType componentType)
+{
+	int index = 0;
+	while ((static_cast<EntityMask>(componentType) >> (index + 1)) != 0)
+	{
+		index++;
+	}
+	return index;
+}
+
+/**
+ * \brief Check that the value is one of the component types, like the type read from a scene file
+ */
+constexpr bool IsComponentType(ComponentType componentType)
+{
+	const auto mask = static_cast<EntityMask>(componentType);
+	return mask != 0 && (mask & (mask - 1)) == 0 && GetComponentTypeIndex(componentType) < COMPONENT_TYPE_NMB;
+}
+
+/**
+ * \brief Compile-time description of a component, specialized next to its manager with SFGE_COMPONENT_TRAITS
+ */
+template<typename T>
+struct ComponentTraits;
+
+#define SFGE_COMPONENT_TRAITS(ComponentClass, ManagerClass, Type) \
+template<> \
+struct ComponentTraits<ComponentClass> \
+{ \
+	using Manager = ManagerClass; \
+	static constexpr ComponentType componentType = Type; \
+	static constexpr int index = GetComponentTypeIndex(Type); \
+	static constexpr EntityMask mask = static_cast<EntityMask>(Type); \
+};
+
 class IComponentFactory
 {
  public:
   virtual void CreateComponent(json& componentJson, Entity entity) = 0;
+  /**
+   * \brief Add a default component to the entity, used when the entity command buffers are flushed
+   */
+  virtual void CreateDefaultComponent(Entity entity) = 0;
+  virtual void DestroyComponent(Entity entity) = 0;
+  /**
+   * \brief Create the same component for all the entities, used by the prefabs.
+   * Managers override it to read the json and load the assets once for all the entities
+   */
+  virtual void CreateComponents(json& componentJson, const std::vector<Entity>& entities)
+  {
+	  for (auto entity : entities)
+	  {
+		  CreateComponent(componentJson, entity);
+	  }
+  }
 };
 
-template<typename T, ComponentType componentType>
+template<typename T, ComponentType componentType, typename TStorage = std::vector<T>>
 class ComponentManager:
     public System,
     public DestroyObserver,
@@ -72,14 +134,19 @@ class ComponentManager:
 {
  protected:
   EntityManager* m_EntityManager = nullptr;
-  std::vector<T> m_Components;
+  TStorage m_Components;
  public:
   ComponentManager(Engine& engine) : System(engine) {}
   ComponentManager(const ComponentManager&) = delete;
   ComponentManager(ComponentManager&& componentManager) = default;
 
   virtual T* AddComponent(Entity entity) = 0;
-  virtual void DestroyComponent(Entity entity) = 0;
+  virtual void DestroyComponent(Entity entity) override = 0;
+
+  void CreateDefaultComponent(Entity entity) override
+  {
+    AddComponent(entity);
+  }
 
   void OnEngineInit() override
   {
@@ -87,15 +154,12 @@ class ComponentManager:
     m_EntityManager = m_Engine.GetEntityManager();
     m_EntityManager->AddDestroyObserver(this);
   }
-  virtual ~ComponentManager()
-  {
-    m_Components.clear();
-  }
+  virtual ~ComponentManager() = default;
 
 
   virtual T* GetComponentPtr(Entity entity) = 0;
 
-  std::vector<T>& GetComponents()
+  TStorage& GetComponents()
   {
     return m_Components;
   }
@@ -105,7 +169,7 @@ class ComponentManager:
 };
 
 
-template<typename TInfo>
+template<typename TInfo, typename TInfoStorage = std::vector<TInfo>>
 class ComponentInfoManager : public editor::IDrawableManager
 {
   static_assert(std::is_base_of<editor::ComponentInfo, TInfo>::value, "TInfo must be derived from ComponentInfo");
@@ -117,25 +181,26 @@ class ComponentInfoManager : public editor::IDrawableManager
 
 
 protected:
-  std::vector<TInfo> m_ComponentsInfo;
+  TInfoStorage m_ComponentsInfo;
   ComponentType m_ComponentType;
 };
 
 
-template<typename T, typename TInfo, ComponentType componentType>
-class BasicComponentManager: public ComponentManager<T, componentType>,
-                             public ComponentInfoManager<TInfo>
+template<typename T, typename TInfo, ComponentType componentType,
+	typename TStorage = std::vector<T>, typename TInfoStorage = std::vector<TInfo>>
+class BasicComponentManager: public ComponentManager<T, componentType, TStorage>,
+                             public ComponentInfoManager<TInfo, TInfoStorage>
 {
 public:
-    BasicComponentManager(Engine& engine) : ComponentManager<T, componentType>(engine), ComponentInfoManager<TInfo>(componentType)
+    BasicComponentManager(Engine& engine) : ComponentManager<T, componentType, TStorage>(engine), ComponentInfoManager<TInfo, TInfoStorage>(componentType)
     {
 
     }
     virtual void DrawOnInspector(Entity entity) override
     {
-      for (auto &info : ComponentInfoManager<TInfo>::m_ComponentsInfo)
+      for (auto &info : ComponentInfoManager<TInfo, TInfoStorage>::m_ComponentsInfo)
       {
-        if (ComponentManager<T, componentType>::m_EntityManager->HasComponent(entity, componentType) && info.GetEntity() == entity)
+        if (ComponentManager<T, componentType, TStorage>::m_EntityManager->HasComponent(entity, componentType) && info.GetEntity() == entity)
         {
           info.DrawOnInspector();
         }
@@ -143,106 +208,231 @@ public:
     }
     virtual void OnEngineInit() override
     {
-		ComponentManager<T, componentType>::OnEngineInit();
-		ComponentManager<T, componentType>::m_Engine.GetEditor()->AddDrawableObserver(this);
-		ComponentManager<T, componentType>::m_Engine.GetSceneManager()->AddComponentManager(this, componentType);
+		ComponentManager<T, componentType, TStorage>::OnEngineInit();
+		ComponentManager<T, componentType, TStorage>::m_Engine.GetEditor()->AddDrawableObserver(this);
+		ComponentManager<T, componentType, TStorage>::m_Engine.GetSceneManager()->AddComponentManager(this, componentType);
 	}
 
 protected:
 	virtual int GetFreeComponentIndex() = 0;
 };
 
+/**
+ * \brief Manager of the components that an entity has at most once, stored in sparse sets so the memory
+ * and the iterations scale with the number of components instead of the number of entities
+ */
 template<class T, class TInfo, ComponentType componentType>
 class SingleComponentManager :
-		public BasicComponentManager<T, TInfo, componentType>,
+		public BasicComponentManager<T, TInfo, componentType, ComponentStorage<T>, ComponentStorage<TInfo>>,
 		public ResizeObserver
 {
 public:
-	SingleComponentManager(Engine& engine):BasicComponentManager<T,TInfo, componentType>(engine)
+	using Base = BasicComponentManager<T, TInfo, componentType, ComponentStorage<T>, ComponentStorage<TInfo>>;
+
+	SingleComponentManager(Engine& engine):Base(engine)
 	{
-		BasicComponentManager<T,TInfo, componentType>::m_Components = std::vector<T>{ INIT_ENTITY_NMB };
-        BasicComponentManager<T,TInfo, componentType>::m_ComponentsInfo = std::vector<TInfo>{ INIT_ENTITY_NMB };
-        for(int i = 0; i < INIT_ENTITY_NMB;i++)
-        {
-          BasicComponentManager<T,TInfo, componentType>::m_ComponentsInfo[i].SetEntity(i+1);
-        }
+		Base::m_Components.ResizeEntityNmb(INIT_ENTITY_NMB);
+		Base::m_ComponentsInfo.ResizeEntityNmb(INIT_ENTITY_NMB);
 	}
 
 	virtual void OnEngineInit() override
 	{
-		BasicComponentManager<T,TInfo, componentType>::OnEngineInit();
-		BasicComponentManager<T,TInfo, componentType>::m_EntityManager = System::m_Engine.GetEntityManager();
-		BasicComponentManager<T,TInfo, componentType>::m_EntityManager->AddResizeObserver(this);
+		Base::OnEngineInit();
+		Base::m_EntityManager = System::m_Engine.GetEntityManager();
+		Base::m_EntityManager->AddResizeObserver(this);
+		const auto* config = System::m_Engine.GetConfig();
+		m_StoreComponentsInfo = config == nullptr || config->editor;
+		if (!m_StoreComponentsInfo)
+		{
+			Base::m_ComponentsInfo.ResizeEntityNmb(0);
+		}
+		if (ArchetypeStorage* archetypeStorage = Base::m_EntityManager->GetArchetypeStorage())
+		{
+			constexpr int componentTypeIndex = GetComponentTypeIndex(componentType);
+			archetypeStorage->RegisterComponentType<T>(componentTypeIndex);
+			Base::m_Components.UseArchetypeStorage(archetypeStorage, componentTypeIndex);
+		}
 	}
 	virtual ~SingleComponentManager()
 	{
 	}
 
-	TInfo& GetComponentInfo(Entity entity)
+	/**
+	 * \brief Remove the components of the previous scene, their entities are reused by the next one
+	 */
+	virtual void OnBeforeSceneLoad() override
 	{
-		if (entity == INVALID_ENTITY)
+		Base::m_Components.Clear();
+		Base::m_ComponentsInfo.Clear();
+	}
+
+	virtual void DrawOnInspector(Entity entity) override
+	{
+		if (Base::m_EntityManager->HasComponent(entity, componentType))
 		{
-			Log::GetInstance()->Error("Trying to get component from INVALID_ENTITY");
+			if (auto* info = Base::m_ComponentsInfo.Get(entity))
+			{
+				info->DrawOnInspector();
+			}
 		}
-		return BasicComponentManager<T,TInfo, componentType>::m_ComponentsInfo[entity - 1];
 	}
 
-	virtual T* GetComponentPtr(Entity entity) override
+	/**
+	 * \brief Return the editor info of the entity, created on first use
+	 * \return nullptr without the editor, as the infos are not stored, or for an outdated entity
+	 */
+	TInfo* GetComponentInfo(Entity entity)
 	{
+		if (!m_StoreComponentsInfo)
+		{
+			return nullptr;
+		}
 		if (entity == INVALID_ENTITY)
 		{
 			Log::GetInstance()->Error("Trying to get component from INVALID_ENTITY");
+			return nullptr;
+		}
+		const bool isNewInfo = !Base::m_ComponentsInfo.Contains(entity);
+		auto* info = Base::m_ComponentsInfo.Insert(entity);
+		if (info == nullptr)
+		{
+			Log::GetInstance()->Error("[Error] Trying to get component info from an outdated entity");
+			return nullptr;
+		}
+		if (isNewInfo)
+		{
+			info->SetEntity(entity);
 		}
-		return &BasicComponentManager<T,TInfo, componentType>::m_Components[entity - 1];
+		return info;
 	}
 
-	T& GetComponentRef(Entity entity)
+	/**
+	 * \return The component of the entity or nullptr when it has none
+	 * Final so the calls through the manager type are dispatched statically
+	 */
+	T* GetComponentPtr(Entity entity) final
 	{
 		if (entity == INVALID_ENTITY)
 		{
 			Log::GetInstance()->Error("Trying to get component from INVALID_ENTITY");
 		}
-		return BasicComponentManager<T,TInfo, componentType>::m_Components[entity - 1];
+		return Base::m_Components.Get(entity);
+	}
+
+	/**
+	 * \brief Return the component of the entity, a default component is stored and the component type
+	 * is added to the entity mask when it has none
+	 * \return nullptr when the entity is not alive or the handle is outdated
+	 */
+	T* GetOrCreateComponent(Entity entity)
+	{
+		if (!Base::m_EntityManager->IsEntityValid(entity))
+		{
+			std::ostringstream oss;
+			oss << "[Error] Trying to create a component for invalid entity: " << entity;
+			Log::GetInstance()->Error(oss.str());
+			return nullptr;
+		}
+		auto* component = Base::m_Components.Insert(entity);
+		if (component == nullptr)
+		{
+			std::ostringstream oss;
+			oss << "[Error] Entity " << entity << " reuses the index of an entity whose component was not removed";
+			Log::GetInstance()->Error(oss.str());
+			return nullptr;
+		}
+		if (!Base::m_EntityManager->HasComponent(entity, componentType))
+		{
+			Base::m_EntityManager->AddComponentType(entity, componentType);
+		}
+		return component;
+	}
+
+	virtual void OnDestroy(Entity entity) override
+	{
+		RemoveComponent(entity);
 	}
 
 	void OnResize(size_t newSize) override
 	{
-		BasicComponentManager<T,TInfo, componentType>::m_Components.resize(newSize);
-		BasicComponentManager<T,TInfo, componentType>::m_ComponentsInfo.resize(newSize);
+		Base::m_Components.ResizeEntityNmb(newSize);
+		if (m_StoreComponentsInfo)
+		{
+			Base::m_ComponentsInfo.ResizeEntityNmb(newSize);
+		}
 	}
 protected:
+	/**
+	 * \brief The infos are only drawn by the editor, false when it is disabled in the configuration
+	 */
+	bool m_StoreComponentsInfo = true;
+
+	/**
+	 * \brief Erase the component and its info from the storage
+	 */
+	void RemoveComponent(Entity entity)
+	{
+		Base::m_Components.Remove(entity);
+		Base::m_ComponentsInfo.Remove(entity);
+	}
 
 	virtual int GetFreeComponentIndex() override { return 0; };
 
 };
 
+/**
+ * \brief Manager of the components that an entity can have several times, stored in paged arrays
+ * so growing them keeps the components in place for the pointers given to Box2D and Python
+ */
 template<class T, class TInfo, ComponentType componentType>
 class MultipleComponentManager : 
-	public BasicComponentManager<T,TInfo, componentType>,
+	public BasicComponentManager<T,TInfo, componentType, PagedVector<T>, PagedVector<TInfo>>,
 	public ResizeObserver
 
 {
  public:
-	MultipleComponentManager(Engine& engine): BasicComponentManager<T,TInfo, componentType>(engine)
+	using Base = BasicComponentManager<T, TInfo, componentType, PagedVector<T>, PagedVector<TInfo>>;
+
+	MultipleComponentManager(Engine& engine): Base(engine)
 	{
-		BasicComponentManager<T,TInfo, componentType>::m_Components = std::vector<T>{ INIT_ENTITY_NMB * MULTIPLE_COMPONENTS_MULTIPLIER};
-		BasicComponentManager<T,TInfo, componentType>::m_ComponentsInfo = std::vector<TInfo>{ INIT_ENTITY_NMB * MULTIPLE_COMPONENTS_MULTIPLIER };
+		Base::m_Components.resize(INIT_ENTITY_NMB * MULTIPLE_COMPONENTS_MULTIPLIER);
+		Base::m_ComponentsInfo.resize(INIT_ENTITY_NMB * MULTIPLE_COMPONENTS_MULTIPLIER);
 	}
 
 	void OnEngineInit() override
     {
-        BasicComponentManager<T,TInfo, componentType>::OnEngineInit();
-		BasicComponentManager<T,TInfo, componentType>::m_EntityManager = BasicComponentManager<T,TInfo, componentType>::m_Engine.GetEntityManager();
-		BasicComponentManager<T,TInfo, componentType>::m_EntityManager->AddResizeObserver(this);
+        Base::OnEngineInit();
+		Base::m_EntityManager = Base::m_Engine.GetEntityManager();
+		Base::m_EntityManager->AddResizeObserver(this);
+		const auto* config = Base::m_Engine.GetConfig();
+		m_StoreComponentsInfo = config == nullptr || config->editor;
+		if (!m_StoreComponentsInfo)
+		{
+			//Release the pages too
+			Base::m_ComponentsInfo = PagedVector<TInfo>();
+		}
     }
 
+	/**
+	 * \brief Only grows, the components are not indexed by entity so the last ones can belong to any entity
+	 */
     virtual void OnResize(size_t newSize) override
     {
-      BasicComponentManager<T,TInfo, componentType>::m_Components = std::vector<T>{ newSize * MULTIPLE_COMPONENTS_MULTIPLIER};
-      BasicComponentManager<T,TInfo, componentType>::m_ComponentsInfo = std::vector<TInfo>{ newSize * MULTIPLE_COMPONENTS_MULTIPLIER };
+		const auto componentNmb = newSize * MULTIPLE_COMPONENTS_MULTIPLIER;
+		if (componentNmb > Base::m_Components.size())
+		{
+			Base::m_Components.resize(componentNmb);
+			if (m_StoreComponentsInfo)
+			{
+				Base::m_ComponentsInfo.resize(componentNmb);
+			}
+		}
     }
 protected:
-
+	/**
+	 * \brief False without the editor, the info array then stays empty
+	 */
+	bool m_StoreComponentsInfo = true;
 };
 
 
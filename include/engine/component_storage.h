@@ -0,0 +1,383 @@
+/*
+MIT License
+
+Copyright (c) 2017 SAE Institute Switzerland AG
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef SFGE_COMPONENT_STORAGE_H
+#define SFGE_COMPONENT_STORAGE_H
+
+#include <algorithm>
+#include <atomic>
+#include <limits>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#include <engine/globals.h>
+#include <engine/paged_vector.h>
+#include <engine/archetype_storage.h>
+#include <engine/job_system.h>
+
+namespace sfge
+{
+
+/**
+ * \brief Sparse set of components, the components are packed in a paged array and the entities index into it.
+ * The components are never moved: a removed component leaves a free slot that the next insertion reuses,
+ * so a pointer to a component stays valid until that component is removed.
+ * ForEach and ParallelForEach walk a list of the used slots sorted by entity index, so they skip the free slots
+ * and visit the components in entity order, the order of the drawing. The free slots are not compacted, which would move the components:
+ * the list is fixed at the first iteration after insertions or removals instead, in O(n + k log k) with k the inserted components.
+ * With UseArchetypeStorage, the components are instead stored in the chunks of the entity archetype,
+ * where adding or removing a component moves the rows and invalidates the pointers
+ */
+template<typename T>
+class ComponentStorage
+{
+public:
+	using iterator = typename PagedVector<T>::iterator;
+	using const_iterator = typename PagedVector<T>::const_iterator;
+	static constexpr unsigned INVALID_INDEX = std::numeric_limits<unsigned>::max();
+
+	/**
+	 * \brief Return the component of the entity, default constructing it when the entity has none
+	 * \return nullptr when the entity index holds the component of another handle, like an outdated one
+	 */
+	T* Insert(Entity entity)
+	{
+		if (entity == INVALID_ENTITY)
+		{
+			return nullptr;
+		}
+		if (m_ArchetypeStorage != nullptr)
+		{
+			return static_cast<T*>(m_ArchetypeStorage->AddComponent(entity, m_ComponentTypeIndex));
+		}
+		const auto entityIndex = GetEntityIndex(entity);
+		if (entityIndex >= m_Sparse.size())
+		{
+			m_Sparse.resize(entityIndex + 1, INVALID_INDEX);
+		}
+		auto& index = m_Sparse[entityIndex];
+		if (index == INVALID_INDEX)
+		{
+			if (!m_FreeIndexes.empty())
+			{
+				//Free slots were reset to a default component on removal
+				index = m_FreeIndexes.back();
+				m_FreeIndexes.pop_back();
+				m_PackedEntities[index] = entity;
+			}
+			else
+			{
+				index = static_cast<unsigned>(m_Packed.size());
+				m_Packed.emplace_back();
+				m_PackedEntities.push_back(entity);
+			}
+			m_InsertedIndexes.push_back(index);
+			m_UsedIndexesDirty.store(true, std::memory_order_release);
+		}
+		else if (m_PackedEntities[index] != entity)
+		{
+			return nullptr;
+		}
+		return &m_Packed[index];
+	}
+	/**
+	 * \brief Remove the component of the entity, its slot is reset to a default component and reused by the next insertion.
+	 * The other components are not moved
+	 */
+	void Remove(Entity entity)
+	{
+		if (m_ArchetypeStorage != nullptr)
+		{
+			m_ArchetypeStorage->RemoveComponent(entity, m_ComponentTypeIndex);
+			return;
+		}
+		const auto index = FindIndex(entity);
+		if (index == INVALID_INDEX)
+		{
+			return;
+		}
+		m_Packed[index] = T();
+		m_PackedEntities[index] = INVALID_ENTITY;
+		m_FreeIndexes.push_back(index);
+		m_Sparse[GetEntityIndex(entity)] = INVALID_INDEX;
+		m_UsedIndexesDirty.store(true, std::memory_order_release);
+	}
+	bool Contains(Entity entity) const
+	{
+		if (m_ArchetypeStorage != nullptr)
+		{
+			return m_ArchetypeStorage->HasComponent(entity, m_ComponentTypeIndex);
+		}
+		return FindIndex(entity) != INVALID_INDEX;
+	}
+	/**
+	 * \return The component of the entity or nullptr when the entity has none
+	 */
+	T* Get(Entity entity)
+	{
+		if (m_ArchetypeStorage != nullptr)
+		{
+			return static_cast<T*>(m_ArchetypeStorage->GetComponent(entity, m_ComponentTypeIndex));
+		}
+		const auto index = FindIndex(entity);
+		return index != INVALID_INDEX ? &m_Packed[index] : nullptr;
+	}
+	const T* Get(Entity entity) const
+	{
+		if (m_ArchetypeStorage != nullptr)
+		{
+			return static_cast<const T*>(m_ArchetypeStorage->GetComponent(entity, m_ComponentTypeIndex));
+		}
+		const auto index = FindIndex(entity);
+		return index != INVALID_INDEX ? &m_Packed[index] : nullptr;
+	}
+	/**
+	 * \brief Entity owning the component at this index of the packed array, only in sparse set mode
+	 * \return INVALID_ENTITY for a free slot
+	 */
+	Entity GetEntity(size_t index) const
+	{
+		return m_PackedEntities[index];
+	}
+	size_t Size() const
+	{
+		if (m_ArchetypeStorage != nullptr)
+		{
+			return m_ArchetypeStorage->GetComponentNmb(m_ComponentTypeIndex);
+		}
+		return m_Packed.size() - m_FreeIndexes.size();
+	}
+	/**
+	 * \brief Call function with the entity and the component, for every component in entity order in sparse set mode
+	 */
+	template<typename F>
+	void ForEach(const F& function)
+	{
+		if (m_ArchetypeStorage != nullptr)
+		{
+			const auto componentTypeIndex = m_ComponentTypeIndex;
+			m_ArchetypeStorage->ForEachChunk(EntityMask(1) << componentTypeIndex,
+				[&function, componentTypeIndex](const ArchetypeChunkView& chunk)
+			{
+				auto* components = chunk.GetColumn<T>(componentTypeIndex);
+				for (size_t i = 0; i < chunk.count; i++)
+				{
+					function(chunk.entities[i], components[i]);
+				}
+			});
+			return;
+		}
+		UpdateUsedIndexes();
+		for (const auto index : m_UsedIndexes)
+		{
+			function(m_PackedEntities[index], m_Packed[index]);
+		}
+	}
+	/**
+	 * \brief ForEach split between the workers of the job system, by chunk in archetype mode
+	 */
+	template<typename F>
+	void ParallelForEach(JobSystem& jobSystem, const F& function)
+	{
+		if (m_ArchetypeStorage != nullptr)
+		{
+			const auto componentTypeIndex = m_ComponentTypeIndex;
+			m_ArchetypeStorage->ParallelForEachChunk(jobSystem, EntityMask(1) << componentTypeIndex,
+				[&function, componentTypeIndex](const ArchetypeChunkView& chunk)
+			{
+				auto* components = chunk.GetColumn<T>(componentTypeIndex);
+				for (size_t i = 0; i < chunk.count; i++)
+				{
+					function(chunk.entities[i], components[i]);
+				}
+			});
+			return;
+		}
+		UpdateUsedIndexes();
+		const auto* entities = m_PackedEntities.data();
+		const auto* usedIndexes = m_UsedIndexes.data();
+		auto& packed = m_Packed;
+		const size_t minChunkSize = sizeof(T) < PARALLEL_FOR_MIN_CHUNK_BYTES ? PARALLEL_FOR_MIN_CHUNK_BYTES / sizeof(T) : 1;
+		jobSystem.ParallelFor(0, m_UsedIndexes.size(), minChunkSize,
+			[&function, entities, usedIndexes, &packed](size_t start, size_t end)
+		{
+			for (auto i = start; i < end; i++)
+			{
+				const auto index = usedIndexes[i];
+				function(entities[index], packed[index]);
+			}
+		});
+	}
+	/**
+	 * \brief Move the storage of the components to the archetype chunks, called before any component is inserted
+	 */
+	void UseArchetypeStorage(ArchetypeStorage* archetypeStorage, int componentTypeIndex)
+	{
+		if (archetypeStorage == m_ArchetypeStorage)
+		{
+			return;
+		}
+		Clear();
+		m_ArchetypeStorage = archetypeStorage;
+		m_ComponentTypeIndex = componentTypeIndex;
+	}
+	bool IsArchetypeStorage() const
+	{
+		return m_ArchetypeStorage != nullptr;
+	}
+	/**
+	 * \brief Packed array of components, used to iterate or to split the work between the jobs, empty in archetype mode.
+	 * It contains the free slots, whose entity in GetEntities is INVALID_ENTITY
+	 */
+	PagedVector<T>& GetComponents()
+	{
+		return m_Packed;
+	}
+	const std::vector<Entity>& GetEntities() const
+	{
+		return m_PackedEntities;
+	}
+	/**
+	 * \brief Reserve the entity to index map, the packed array only grows with the inserted components
+	 */
+	void ResizeEntityNmb(size_t entityNmb)
+	{
+		for (auto entityIndex = m_Sparse.size(); entityIndex > entityNmb; entityIndex--)
+		{
+			const auto index = m_Sparse[entityIndex - 1];
+			if (index != INVALID_INDEX)
+			{
+				Remove(m_PackedEntities[index]);
+			}
+		}
+		m_Sparse.resize(entityNmb, INVALID_INDEX);
+	}
+	void Clear()
+	{
+		if (m_ArchetypeStorage != nullptr)
+		{
+			m_ArchetypeStorage->ClearComponentType(m_ComponentTypeIndex);
+			return;
+		}
+		m_Packed.clear();
+		m_PackedEntities.clear();
+		m_FreeIndexes.clear();
+		m_UsedIndexes.clear();
+		m_InsertedIndexes.clear();
+		m_InsertedMarks.clear();
+		m_UsedIndexesDirty.store(false, std::memory_order_release);
+		m_Sparse.assign(m_Sparse.size(), INVALID_INDEX);
+	}
+
+	iterator begin() { return m_Packed.begin(); }
+	iterator end() { return m_Packed.end(); }
+	const_iterator begin() const { return m_Packed.begin(); }
+	const_iterator end() const { return m_Packed.end(); }
+private:
+	PagedVector<T> m_Packed;
+	std::vector<Entity> m_PackedEntities;
+	/**
+	 * \brief Slots of the removed components, reused by the insertions before growing the packed array
+	 */
+	std::vector<unsigned> m_FreeIndexes;
+	/**
+	 * \brief Used slots sorted by the index of their entity, walked by ForEach and ParallelForEach
+	 */
+	std::vector<unsigned> m_UsedIndexes;
+	/**
+	 * \brief Slots given to an entity since the used slots were sorted, a slot can be there twice
+	 */
+	std::vector<unsigned> m_InsertedIndexes;
+	std::vector<unsigned char> m_InsertedMarks;
+	std::atomic<bool> m_UsedIndexesDirty{ false };
+	std::mutex m_UsedIndexesMutex;
+	/**
+	 * \brief Drop the freed and reused slots from the sorted list and merge the inserted ones.
+	 * Locked as two systems reading the same components can iterate at the same time
+	 */
+	void UpdateUsedIndexes()
+	{
+		if (!m_UsedIndexesDirty.load(std::memory_order_acquire))
+		{
+			return;
+		}
+		std::lock_guard<std::mutex> lock(m_UsedIndexesMutex);
+		if (!m_UsedIndexesDirty.load(std::memory_order_relaxed))
+		{
+			return;
+		}
+		m_InsertedMarks.resize(m_Packed.size(), 0);
+		for (const auto index : m_InsertedIndexes)
+		{
+			m_InsertedMarks[index] = 1;
+		}
+		//A reused slot belongs to another entity, it is moved to the position of its new entity
+		m_UsedIndexes.erase(std::remove_if(m_UsedIndexes.begin(), m_UsedIndexes.end(), [this](unsigned index)
+		{
+			return m_PackedEntities[index] == INVALID_ENTITY || m_InsertedMarks[index] != 0;
+		}), m_UsedIndexes.end());
+		const auto sortedEnd = m_UsedIndexes.size();
+		for (const auto index : m_InsertedIndexes)
+		{
+			if (m_InsertedMarks[index] == 1 && m_PackedEntities[index] != INVALID_ENTITY)
+			{
+				m_UsedIndexes.push_back(index);
+			}
+			m_InsertedMarks[index] = 2;
+		}
+		for (const auto index : m_InsertedIndexes)
+		{
+			m_InsertedMarks[index] = 0;
+		}
+		m_InsertedIndexes.clear();
+		const auto entityOrder = [this](unsigned index, unsigned otherIndex)
+		{
+			return GetEntityIndex(m_PackedEntities[index]) < GetEntityIndex(m_PackedEntities[otherIndex]);
+		};
+		std::sort(m_UsedIndexes.begin() + sortedEnd, m_UsedIndexes.end(), entityOrder);
+		std::inplace_merge(m_UsedIndexes.begin(), m_UsedIndexes.begin() + sortedEnd, m_UsedIndexes.end(), entityOrder);
+		m_UsedIndexesDirty.store(false, std::memory_order_release);
+	}
+	/**
+	 * \brief Index of the component in the packed array, INVALID_INDEX when the entity has none or the handle is outdated
+	 */
+	unsigned FindIndex(Entity entity) const
+	{
+		const auto entityIndex = GetEntityIndex(entity);
+		if (entity == INVALID_ENTITY || entityIndex >= m_Sparse.size())
+		{
+			return INVALID_INDEX;
+		}
+		const auto index = m_Sparse[entityIndex];
+		return index != INVALID_INDEX && m_PackedEntities[index] == entity ? index : INVALID_INDEX;
+	}
+
+	std::vector<unsigned> m_Sparse;
+	ArchetypeStorage* m_ArchetypeStorage = nullptr;
+	int m_ComponentTypeIndex = -1;
+};
+
+}
+#endif
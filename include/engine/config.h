@@ -62,6 +62,37 @@ struct Configuration
 	 */
 	unsigned int maxFramerate = 60;
 	float fixedDeltaTime = 0.02f;
+	/**
+	 * \brief Number of fixed ticks simulated by a windowLess Engine, 0 runs until the Engine stops
+	 */
+	unsigned int headlessTickNmb = 0;
+	/**
+	 * \brief Maximum number of fixed updates done in one frame to catch up, the remaining time is dropped
+	 */
+	unsigned int maxFixedUpdatesPerFrame = 5;
+	/**
+	 * \brief Render the transforms blended between the last two fixed updates
+	 */
+	bool interpolateTransforms = true;
+	/**
+	 * \brief Draw on a render thread the snapshot of the previous frame while the next one is simulated.
+	 * The render thread owns the OpenGL context, so the editor, the python OnDraw and the debug drawing
+	 * (Graphics2dManager::DrawLine and DrawVector) are disabled. Sprites and shapes keep the drawing order of the main thread.
+	 */
+	bool pipelinedRendering = false;
+	/**
+	 * \brief Store the single components in chunks grouped by the component types of the entity instead of one sparse set per type
+	 */
+	bool archetypeStorage = false;
+	/**
+	 * \brief Keep the transforms in one array per field inside the Transform2dManager instead of Transform2d structs,
+	 * for the systems running the Transform2dSoA kernels on them. Ignored with archetypeStorage
+	 */
+	bool transformSoA = false;
+	/**
+	 * \brief Size in bytes of the frame allocator of each worker thread, reset at the start of every frame
+	 */
+	size_t frameAllocatorSize = 1024 * 1024;
 	int velocityIterations = 8;
 	int positionIterations = 2;
 	size_t currentEntitiesNmb = INIT_ENTITY_NMB;
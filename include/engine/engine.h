@@ -29,9 +29,10 @@ SOFTWARE.
 
 #include <memory>
 #include <string>
-#include <ctpl_stl.h>
-
+#include <vector>
 #include <engine/config.h>
+#include <engine/job_system.h>
+#include <engine/task_graph.h>
 #include <utility/json_utility.h>
 
 #include <editor/profiler.h>
@@ -59,6 +60,9 @@ class Physics2dManager;
 class EntityManager;
 class Transform2dManager;
 class Editor;
+class Snapshot;
+class LinearAllocator;
+class AllocatorResource;
 struct SystemsContainer;
 
 /**
@@ -75,7 +79,7 @@ public:
 	void Init(json& configJson);
 	void Init(std::unique_ptr<Configuration> config);
 	/**
-	* \brief Starting the Game Engine after the Init()
+	* \brief Starting the Game Engine after the Init(), runs the headless loop if the Configuration is windowLess
 	*/
 	void Start();
 
@@ -88,6 +92,15 @@ public:
 	* \brief Reload is used after loading a new scene
 	*/
 	void Collect();
+	/**
+	* \brief Copy the entities, transforms, bodies and python system states into the snapshot
+	*/
+	void SaveSnapshot(Snapshot& snapshot);
+	/**
+	* \brief Roll the simulation back to the saved snapshot, entities created since are destroyed
+	* \return false if an entity of the snapshot was destroyed or changed its components since, nothing is restored then
+	*/
+	bool RestoreSnapshot(Snapshot& snapshot);
 
 	~Engine();
 	/**
@@ -106,21 +119,66 @@ public:
 	Transform2dManager* GetTransform2dManager();
 	Editor* GetEditor();
 
-	ctpl::thread_pool& GetThreadPool();
+	JobSystem& GetJobSystem();
+	/**
+	* \brief Scratch allocator of the calling worker thread, everything allocated in it is released at the start of the next frame
+	*/
+	LinearAllocator& GetFrameAllocator();
+	/**
+	* \brief The frame allocator of the calling worker thread as a memory resource for the std::pmr containers
+	*/
+	AllocatorResource& GetFrameResource();
 	ProfilerFrameData& GetProfilerFrameData();
 	float GetTimeSinceInit();
 	float GetDeltaTime();
+	/**
+	* \brief Ratio between the time left in the fixed update accumulator and the fixed delta time, used to blend the previous and current transforms
+	*/
+	float GetFixedUpdateAlpha() const;
+	/**
+	* \brief Simulate one tick of the headless loop at fixedDeltaTime, tests call it to check the state before Destroy
+	*/
+	void HeadlessTick();
+	/**
+	* \brief Add the frame time to the fixed update accumulator and run the fixed updates it holds,
+	* at most maxFixedUpdatesPerFrame, the time left sets the alpha of GetFixedUpdateAlpha
+	* \return The number of fixed updates run
+	*/
+	unsigned int RunFixedUpdates(float dt);
 	bool running = false;
 protected:
 	void InitModules();
-	ctpl::thread_pool m_ThreadPool;
+	/**
+	* \brief Run one step of the physics and the fixed updates at fixedDeltaTime
+	*/
+	void FixedUpdate();
+	/**
+	* \brief Declare the update and fixed update of each system with the component types it reads and writes,
+	* called again after each scene load as the python systems declare their own component types
+	*/
+	void InitUpdateGraph();
+	/**
+	* \brief Fixed step loop without window, running the simulation as fast as possible
+	*/
+	void StartHeadless();
+	void ResetFrameAllocators();
+	JobSystem m_JobSystem;
+	std::vector<std::unique_ptr<char[]>> m_FrameMemory;
+	std::vector<std::unique_ptr<LinearAllocator>> m_FrameAllocators;
+	std::vector<std::unique_ptr<AllocatorResource>> m_FrameResources;
 	sf::RenderWindow* m_Window = nullptr;
 	std::unique_ptr<Configuration> m_Config;
 	float m_DeltaTime = 0.0f;
+	float m_FixedUpdateAlpha = 0.0f;
+	float m_FixedUpdateAccumulator = 0.0f;
 	sf::Clock m_EngineClock;
 	Remotery* rmt;
 	//
 	std::unique_ptr<SystemsContainer> m_SystemsContainer;
+	TaskGraph m_UpdateGraph;
+	TaskGraph m_FixedUpdateGraph;
+	//Set by Collect, the graphs are rebuilt before their next execution as a scene can be loaded by a running task
+	bool m_UpdateGraphDirty = false;
 
   	ProfilerFrameData m_FrameData;
 
@@ -25,8 +25,12 @@ SOFTWARE.
 #ifndef SFGE_ENTITY_H
 #define SFGE_ENTITY_H
 
+#include <cstdint>
 #include <vector>
 #include <set>
+#include <memory>
+#include <string>
+#include <unordered_map>
 
 #include <engine/system.h>
 #include <editor/editor_info.h>
@@ -34,7 +38,11 @@ SOFTWARE.
 
 namespace sfge
 {
-enum class ComponentType : int;
+enum class ComponentType : std::uint64_t;
+class ArchetypeStorage;
+class Snapshot;
+template<typename T>
+struct ComponentTraits;
 
 class ResizeObserver
 {
@@ -46,12 +54,21 @@ class DestroyObserver
 {
  public:
   virtual void OnDestroy(Entity entity) = 0;
+  /**
+   * \brief Called once per flush of the command buffers with all the entities they destroyed
+   */
+  virtual void OnDestroyEntities(const std::vector<Entity>& entities)
+  {
+	  for (auto entity : entities)
+	  {
+		  OnDestroy(entity);
+	  }
+  }
 };
 /**
- * \brief Entity index number, starting from 1U
+ * \brief One bit per ComponentType
  */
-
-using EntityMask = int;
+using EntityMask = std::uint64_t;
 
 namespace editor
 {
@@ -63,34 +80,242 @@ void DrawOnInspector() override;
 
 }
 
+/**
+ * \brief Persistent list of the entities having all the component types of the mask, kept up to date by the EntityManager
+ * so iterating it does not scan nor allocate. The order of the entities changes when one leaves the query
+ */
+class EntityQuery
+{
+public:
+	using const_iterator = std::vector<Entity>::const_iterator;
+
+	explicit EntityQuery(EntityMask mask);
+
+	EntityMask GetMask() const;
+	bool Matches(EntityMask entityMask) const;
+	const std::vector<Entity>& GetEntities() const;
+	size_t Size() const;
+
+	const_iterator begin() const { return m_Entities.begin(); }
+	const_iterator end() const { return m_Entities.end(); }
+private:
+	friend class EntityManager;
+	void Add(Entity entity);
+	void Remove(Entity entity);
+	void Clear();
+
+	EntityMask m_Mask;
+	std::vector<Entity> m_Entities;
+	/**
+	 * \brief Position of each entity in m_Entities indexed by entity index
+	 */
+	std::vector<unsigned> m_Positions;
+};
+
+/**
+ * \brief Applied in this order by EntityManager::FlushCommandBuffers
+ */
+enum class EntityCommandType : std::uint8_t
+{
+	CREATE,
+	ADD_COMPONENT_TYPE,
+	REMOVE_COMPONENT_TYPE,
+	DESTROY
+};
+
+struct EntityCommand
+{
+	EntityCommandType type;
+	Entity entity;
+	EntityMask mask;
+};
+
+/**
+ * \brief Structural changes recorded by one thread while the systems run in parallel,
+ * applied by EntityManager::FlushCommandBuffers at the next sync point
+ */
+class EntityCommandBuffer
+{
+public:
+	/**
+	 * \brief Record the creation of an entity with a default component of each type of the mask
+	 */
+	void CreateEntity(EntityMask mask = 0);
+	void DestroyEntity(Entity entity);
+	/**
+	 * \brief Record the creation of a default component, by the manager of the component type at the flush
+	 */
+	void AddComponentType(Entity entity, ComponentType componentType);
+	/**
+	 * \brief Record the destruction of the component, by the manager of the component type at the flush
+	 */
+	void RemoveComponentType(Entity entity, ComponentType componentType);
+
+	bool IsEmpty() const;
+	const std::vector<EntityCommand>& GetCommands() const;
+	/**
+	 * \brief Entities created by the last flush, in the order of the CreateEntity calls
+	 */
+	const std::vector<Entity>& GetCreatedEntities() const;
+private:
+	friend class EntityManager;
+
+	std::vector<EntityCommand> m_Commands;
+	std::vector<Entity> m_CreatedEntities;
+};
+
 class EntityManager : public System
 {
 public:
-	using System::System;
+	EntityManager(Engine& engine);
+	~EntityManager();
 	void OnEngineInit() override;
 
 	void OnBeforeSceneLoad() override;
 
+	/**
+	 * \return The component types of the entity, an empty mask when the entity is not alive or the handle is outdated
+	 */
 	EntityMask GetMask(Entity entity);
 	Entity CreateEntity(Entity wantedEntity);
+	/**
+	 * \brief Take count entities from the free list at once, fewer when there are not enough free entities
+	 */
+	std::vector<Entity> CreateEntities(size_t count);
 	void DestroyEntity(Entity entity);
+	/**
+	 * \brief Destroy the entities together, the destroy observers are notified once with all of them
+	 */
+	void DestroyEntities(const std::vector<Entity>& entities);
+	/**
+	 * \brief Command buffer of the calling worker thread, safe to record in from the jobs without locking
+	 */
+	EntityCommandBuffer& GetCommandBuffer();
+	/**
+	 * \brief Apply the commands of all the buffers, sorted by type then by entity index.
+	 * Called by the Engine at the sync points, when no job is recording
+	 */
+	void FlushCommandBuffers();
+	/**
+	 * \brief Set by the Engine while python systems declaring their components run beside the jobs,
+	 * the python bindings then refuse the structural changes or record them in the command buffer
+	 */
+	void SetStructuralChangesLocked(bool locked);
+	bool AreStructuralChangesLocked() const;
+	/**
+	 * \brief Write the masks, versions and free list of the entities
+	 */
+	void SaveSnapshot(Snapshot& snapshot) const;
+	/**
+	 * \brief Destroy the entities created since the snapshot and restore the versions and free list, so the next entities get the same handles.
+	 * Fails without changing anything when an entity of the snapshot was destroyed or changed its component types since
+	 */
+	bool RestoreSnapshot(Snapshot& snapshot);
+	/**
+	 * \brief Check that the entity is alive and that the handle is not kept from a destroyed entity whose index was reused
+	 */
+	bool IsEntityValid(Entity entity) const;
+	/**
+	 * \return The handle of the alive entity at this index, INVALID_ENTITY when the index is free
+	 */
+	Entity GetEntityByIndex(size_t entityIndex) const;
 	bool HasComponent(Entity entity, ComponentType componentType);
+	/**
+	 * \brief HasComponent with the mask of the component known at compile time from its ComponentTraits
+	 */
+	template<typename T>
+	bool HasComponent(Entity entity) const
+	{
+		const auto entityIndex = GetEntityIndex(entity);
+		return entity != INVALID_ENTITY && entityIndex < m_EntityVersions.size() &&
+			m_EntityVersions[entityIndex] == GetEntityVersion(entity) &&
+			(m_MaskArray[entityIndex] & ComponentTraits<T>::mask) == ComponentTraits<T>::mask;
+	}
+	/**
+	 * \brief Set the component type bit of the entity, outdated handles are rejected
+	 */
 	void AddComponentType(Entity entity, ComponentType componentType);
 	void RemoveComponentType(Entity entity, ComponentType componentType);
-	editor::EntityInfo& GetEntityInfo(Entity entity);
+	/**
+	 * \return The editor info of the entity, nullptr when the entity is not alive or the handle is outdated
+	 */
+	editor::EntityInfo* GetEntityInfo(Entity entity);
 
+	/**
+	 * \brief Rename the entity and update the name index used by GetEntityByName
+	 */
+	void SetEntityName(Entity entity, const std::string& entityName);
+	/**
+	 * \brief Give the same name to all the entities, the name index grows once for all of them
+	 */
+	void SetEntitiesName(const std::vector<Entity>& entities, const std::string& entityName);
+	/**
+	 * \brief Find the entity in the name index in O(1), INVALID_ENTITY when no alive entity has this name
+	 */
 	Entity GetEntityByName(std::string entityName) const;
+	/**
+	 * \brief Resolve many names at once, the entities are in the order of the names
+	 */
+	std::vector<Entity> GetEntitiesByName(const std::vector<std::string>& entityNames) const;
 	void ResizeEntityNmb(size_t newSize);
 	void AddResizeObserver(ResizeObserver *resizeObserver);
 	void AddDestroyObserver(DestroyObserver *destroyObserver);
 
-	std::vector<Entity> GetEntitiesWithType(ComponentType componentType);
+	/**
+	 * \brief Return the entities of the cached query of this component type, kept up to date by the manager
+	 */
+	const std::vector<Entity>& GetEntitiesWithType(ComponentType componentType);
+	/**
+	 * \brief Return the cached query of the entities having all these component types, created on first use
+	 */
+	EntityQuery& GetQuery(EntityMask mask);
+	EntityQuery& GetQuery(const std::vector<ComponentType>& componentTypes);
+	/**
+	 * \brief Scan the masks in bulk for the alive entities having all the required component types and none of the excluded ones
+	 * \param entities Cleared and filled with the matching entities
+	 */
+	void FindEntities(EntityMask requiredMask, EntityMask excludedMask, std::vector<Entity>& entities) const;
+	/**
+	 * \brief Chunk storage shared by the single component managers, nullptr when archetypeStorage is disabled in the configuration
+	 */
+	ArchetypeStorage* GetArchetypeStorage();
 
 private:
 	std::vector<EntityMask> m_MaskArray{ INIT_ENTITY_NMB };
 	std::vector<editor::EntityInfo> m_EntityInfos{ INIT_ENTITY_NMB };
+	std::vector<unsigned> m_EntityVersions;
+	std::vector<bool> m_EntityAlive;
+	/**
+	 * \brief Stack of the free entity indexes, CreateEntity and DestroyEntity are O(1)
+	 */
+	std::vector<size_t> m_FreeEntityIndexes;
+	std::unordered_multimap<std::string, Entity> m_EntityNameIndex;
+	bool m_StructuralChangesLocked = false;
+	std::vector<std::unique_ptr<EntityQuery>> m_Queries;
 	std::set<ResizeObserver*> m_ResizeObservers;
 	std::set<DestroyObserver*> m_DestroyObservers;
+	std::unique_ptr<ArchetypeStorage> m_ArchetypeStorage;
+	/**
+	 * \brief One command buffer per worker of the job system
+	 */
+	std::vector<std::unique_ptr<EntityCommandBuffer>> m_CommandBuffers;
+	std::vector<EntityCommand> m_FlushedCommands;
+	std::vector<Entity> m_DestroyedEntities;
+
+	/**
+	 * \brief Remove the entity from the storages after its destroy observers were notified
+	 */
+	void ReleaseEntity(Entity entity);
+	void RemoveEntityName(size_t entityIndex);
+	void AddFreeEntityIndexes(size_t begin, size_t end);
+	/**
+	 * \brief Create the component with the manager of its type, a type without manager only gets its bit in the mask
+	 */
+	void AddComponentFromCommand(Entity entity, ComponentType componentType);
+	/**
+	 * \brief Destroy the component with the manager of its type and clear its bit in the mask
+	 */
+	void RemoveComponentFromCommand(Entity entity, ComponentType componentType);
 };
 /*
 template <>
@@ -27,6 +27,7 @@
 #ifndef SFGE_GLOBALS_H
 #define SFGE_GLOBALS_H
 
+#include <cstddef>
 
 #if ((ULONG_MAX) == (UINT_MAX))
 #define IS64BIT
@@ -39,8 +40,33 @@
 
 #define SFGE_VERSION 0.2
 
+/**
+ * \brief Entity handle, the low bits are the index of the entity slot starting from 1U and the high bits are the version of the slot.
+ * The version is incremented when the entity is destroyed, so the handles kept on a destroyed entity are detected as invalid
+ */
 using Entity = unsigned;
 const Entity INVALID_ENTITY = 0U;
+const unsigned ENTITY_INDEX_BITS = 20U;
+const unsigned ENTITY_VERSION_BITS = 12U;
+const Entity ENTITY_INDEX_MASK = (1U << ENTITY_INDEX_BITS) - 1U;
+const unsigned ENTITY_VERSION_MASK = (1U << ENTITY_VERSION_BITS) - 1U;
+const size_t MAX_ENTITY_NMB = ENTITY_INDEX_MASK;
+
+/**
+ * \brief Index of the entity slot starting from 0, used to index the arrays of the entities
+ */
+constexpr size_t GetEntityIndex(Entity entity)
+{
+	return static_cast<size_t>(entity & ENTITY_INDEX_MASK) - 1U;
+}
+constexpr unsigned GetEntityVersion(Entity entity)
+{
+	return entity >> ENTITY_INDEX_BITS;
+}
+constexpr Entity MakeEntity(size_t entityIndex, unsigned version)
+{
+	return ((version & ENTITY_VERSION_MASK) << ENTITY_INDEX_BITS) | static_cast<Entity>(entityIndex + 1U);
+}
 const size_t  MULTIPLE_COMPONENTS_MULTIPLIER = 4;
 enum class ModuleType
 {
@@ -0,0 +1,262 @@
+/*
+MIT License
+
+Copyright (c) 2017 SAE Institute Switzerland AG
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef SFGE_JOB_SYSTEM_H
+#define SFGE_JOB_SYSTEM_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace sfge
+{
+
+const size_t CACHE_LINE_SIZE = 64;
+/**
+ * \brief Below this amount of component data, the scheduling costs more than running the loop on one thread
+ */
+const size_t PARALLEL_FOR_MIN_CHUNK_BYTES = 4096;
+
+/**
+ * \brief Number of jobs not finished yet, the owner waits on it with JobSystem::Wait
+ */
+struct JobCounter
+{
+	std::atomic<int> value{0};
+	bool IsDone() const { return value.load(std::memory_order_acquire) == 0; }
+};
+
+/**
+ * \brief Job with its closure stored inline, allocated from the ring buffer of the scheduling thread
+ */
+struct Job
+{
+	static const size_t CLOSURE_SIZE = 64;
+
+	void (*function)(void* closure) = nullptr;
+	void (*destructor)(void* closure) = nullptr;
+	JobCounter* counter = nullptr;
+	//Set from the allocation to the end of the execution, the ring slot cannot be reused before
+	std::atomic<bool> inUse{false};
+	alignas(std::max_align_t) unsigned char closure[CLOSURE_SIZE];
+};
+
+/**
+ * \brief Work-stealing job system, each worker pops the jobs from the back of its own deque and steals from the front of the others.
+ * The thread calling Init is the worker 0 and helps running jobs while it waits on a counter.
+ */
+class JobSystem
+{
+public:
+	JobSystem() = default;
+	~JobSystem();
+	JobSystem(const JobSystem&) = delete;
+	JobSystem& operator=(const JobSystem&) = delete;
+
+	/**
+	 * \brief Start the worker threads, the calling thread becomes the worker 0
+	 * \param workerThreadNmb Number of threads added to the calling thread
+	 */
+	void Init(size_t workerThreadNmb);
+	/**
+	 * \brief Stop and join the worker threads, the pending jobs are executed before
+	 */
+	void Destroy();
+
+	/**
+	 * \brief Schedule a job on the deque of the calling thread, only the workers and the thread calling Init can schedule,
+	 * the job runs inline on any other thread
+	 * \param function Callable taking no argument, copied inside the job so it should only capture pointers or references
+	 * \param counter Incremented now and decremented when the job is done, can be nullptr
+	 */
+	template<typename F>
+	void Schedule(F&& function, JobCounter* counter);
+	/**
+	 * \brief Run the pending jobs until the counter is done
+	 */
+	void Wait(const JobCounter& counter);
+	/**
+	 * \brief Split [begin, end) in chunks of at least minChunkSize elements executed by the workers,
+	 * the range is executed on the calling thread when it is not bigger than one chunk
+	 * \param function Callable taking the start and end index of a chunk
+	 * \param chunkAlignment The chunk size is a multiple of it, so two workers do not write on the same cache line
+	 */
+	template<typename F>
+	void ParallelFor(size_t begin, size_t end, size_t minChunkSize, const F& function, size_t chunkAlignment = 1);
+	/**
+	 * \brief ParallelFor over a component array, with chunks aligned on cache lines and at least PARALLEL_FOR_MIN_CHUNK_BYTES long
+	 * \param components std::vector or PagedVector of components
+	 * \param function Callable taking the index and a reference of the component
+	 * \param minChunkSize Minimum number of components per chunk, 0 to deduce it from the component size
+	 */
+	template<typename TContainer, typename F>
+	void ParallelForEachComponent(TContainer& components, const F& function, size_t minChunkSize = 0);
+
+	/**
+	 * \brief Number of threads running jobs, the calling thread included
+	 */
+	size_t GetWorkerNmb() const;
+	/**
+	 * \brief Index of the worker running the calling thread, 0 for the threads not started by the job system
+	 */
+	size_t GetCurrentWorkerIndex() const;
+	/**
+	 * \brief True on the worker threads and on the thread calling Init
+	 */
+	bool IsWorkerThread() const;
+private:
+	struct Worker
+	{
+		std::mutex mutex;
+		std::deque<Job*> jobs;
+		std::unique_ptr<Job[]> jobRing;
+		size_t jobRingIndex = 0;
+	};
+	static const size_t JOB_RING_SIZE = 4096;
+
+	Job* AllocateJob();
+	void PushJob(Job* job);
+	Job* PopJob();
+	Job* StealJob(size_t thiefIndex);
+	void Execute(Job* job);
+	void WorkerLoop(size_t workerIndex);
+
+	std::vector<std::unique_ptr<Worker>> m_Workers;
+	std::vector<std::thread> m_Threads;
+	std::atomic<bool> m_Running{false};
+	std::atomic<int> m_PendingJobNmb{0};
+	std::atomic<int> m_SleepingWorkerNmb{0};
+	std::mutex m_WakeMutex;
+	std::condition_variable m_WakeCondition;
+};
+
+template <typename F>
+void JobSystem::Schedule(F&& function, JobCounter* counter)
+{
+	using Closure = typename std::decay<F>::type;
+	static_assert(sizeof(Closure) <= Job::CLOSURE_SIZE, "Job closure is too big, capture a pointer to the data instead");
+	static_assert(alignof(Closure) <= alignof(std::max_align_t), "Job closure is over-aligned");
+
+	if (counter != nullptr)
+	{
+		counter->value.fetch_add(1, std::memory_order_relaxed);
+	}
+	//The job rings are not shared, a thread without its own worker like the render thread runs the job itself
+	if (m_Workers.empty() || !IsWorkerThread())
+	{
+		function();
+		if (counter != nullptr)
+		{
+			counter->value.fetch_sub(1, std::memory_order_release);
+		}
+		return;
+	}
+	auto* job = AllocateJob();
+	new (job->closure) Closure(std::forward<F>(function));
+	job->function = [](void* closure)
+	{
+		(*static_cast<Closure*>(closure))();
+	};
+	job->destructor = [](void* closure)
+	{
+		static_cast<Closure*>(closure)->~Closure();
+	};
+	job->counter = counter;
+	PushJob(job);
+}
+
+template <typename F>
+void JobSystem::ParallelFor(size_t begin, size_t end, size_t minChunkSize, const F& function, size_t chunkAlignment)
+{
+	if (end <= begin)
+	{
+		return;
+	}
+	const size_t length = end - begin;
+	const size_t workerNmb = GetWorkerNmb();
+	if (minChunkSize == 0)
+	{
+		minChunkSize = 1;
+	}
+	if (workerNmb <= 1 || length <= minChunkSize)
+	{
+		function(begin, end);
+		return;
+	}
+	//A few chunks per worker so the stealing can balance uneven chunks
+	const size_t maxChunkNmb = workerNmb * 4;
+	size_t chunkNmb = (length + minChunkSize - 1) / minChunkSize;
+	if (chunkNmb > maxChunkNmb)
+	{
+		chunkNmb = maxChunkNmb;
+	}
+	if (chunkAlignment == 0)
+	{
+		chunkAlignment = 1;
+	}
+	size_t chunkSize = (length + chunkNmb - 1) / chunkNmb;
+	chunkSize = (chunkSize + chunkAlignment - 1) / chunkAlignment * chunkAlignment;
+
+	JobCounter counter;
+	const F* functionPtr = &function;
+	for (size_t chunkBegin = begin + chunkSize; chunkBegin < end; chunkBegin += chunkSize)
+	{
+		const size_t chunkEnd = chunkBegin + chunkSize < end ? chunkBegin + chunkSize : end;
+		Schedule([functionPtr, chunkBegin, chunkEnd]
+		{
+			(*functionPtr)(chunkBegin, chunkEnd);
+		}, &counter);
+	}
+	function(begin, begin + chunkSize < end ? begin + chunkSize : end);
+	Wait(counter);
+}
+
+template <typename TContainer, typename F>
+void JobSystem::ParallelForEachComponent(TContainer& components, const F& function, size_t minChunkSize)
+{
+	using T = typename TContainer::value_type;
+	const size_t componentsPerCacheLine = sizeof(T) < CACHE_LINE_SIZE ? CACHE_LINE_SIZE / sizeof(T) : 1;
+	if (minChunkSize == 0)
+	{
+		minChunkSize = sizeof(T) < PARALLEL_FOR_MIN_CHUNK_BYTES ? PARALLEL_FOR_MIN_CHUNK_BYTES / sizeof(T) : 1;
+	}
+	ParallelFor(0, components.size(), minChunkSize, [&components, &function](size_t start, size_t end)
+	{
+		for (auto i = start; i < end; i++)
+		{
+			function(i, components[i]);
+		}
+	}, componentsPerCacheLine);
+}
+
+}
+#endif
@@ -28,17 +28,17 @@
 
 #include <cstdlib>
 #include <cstdint>
+#include <atomic>
 #include <cassert>
+#include <cstddef>
+#include <memory>
+#include <memory_resource>
+#include <new>
 
 #include <engine/globals.h>
 
-#ifdef IS64BIT
-using ptr_type = long;
-#endif
-
-#ifdef IS32BIT
-using ptr_type = int;
-#endif
+//Pointer sized whatever the order of the includes defining IS64BIT
+using ptr_type = std::intptr_t;
 
 
 namespace sfge
@@ -71,9 +71,12 @@ public:
 
     size_t getSize() const { return _size; }
 
-    size_t getUsedMemory() const { return _used_memory; }
+    /**
+     * \brief Virtual for the allocators shared between threads, which keep their own atomic counts
+     */
+    virtual size_t getUsedMemory() const { return _used_memory; }
 
-    size_t getNumAllocations() const { return _num_allocations; }
+    virtual size_t getNumAllocations() const { return _num_allocations; }
 
 protected:
 
@@ -247,6 +250,65 @@ private:
     FreeBlock* _free_blocks;
 };
 
+/**
+ * \brief Two-Level Segregated Fit allocator, general purpose with allocate and deallocate in constant time.
+ * The free blocks are sorted in size classes: a power of two first level split in linear second level ranges,
+ * with a bitmap per level so the smallest class holding a large enough block is found with bit scans.
+ * Neighbouring free blocks are merged right away, which bounds the fragmentation
+ */
+class TlsfAllocator : public Allocator
+{
+public:
+
+    TlsfAllocator(size_t size, void* start);
+    ~TlsfAllocator();
+
+    void* allocate(size_t size, ptr_type alignment) override;
+    void deallocate(void* p) override;
+
+private:
+
+    struct BlockHeader
+    {
+        BlockHeader* prev_physical;
+        //Size of the payload, the lowest bit flags the free blocks
+        size_t size;
+        //Only used while the block is free, overlapping the start of the payload otherwise
+        BlockHeader* next_free;
+        BlockHeader* prev_free;
+    };
+
+    static constexpr size_t ALIGN_SIZE_LOG2 = 3;
+    static constexpr size_t ALIGN_SIZE = 1 << ALIGN_SIZE_LOG2;
+    static constexpr size_t SL_INDEX_COUNT_LOG2 = 5;
+    static constexpr size_t SL_INDEX_COUNT = 1 << SL_INDEX_COUNT_LOG2;
+    static constexpr size_t FL_INDEX_SHIFT = SL_INDEX_COUNT_LOG2 + ALIGN_SIZE_LOG2;
+    static constexpr size_t FL_INDEX_MAX = sizeof(size_t) == 8 ? 38 : 30;
+    static constexpr size_t FL_INDEX_COUNT = FL_INDEX_MAX - FL_INDEX_SHIFT + 1;
+    static constexpr size_t SMALL_BLOCK_SIZE = 1 << FL_INDEX_SHIFT;
+    static constexpr size_t BLOCK_OVERHEAD = 2 * sizeof(void*);
+    static constexpr size_t BLOCK_SIZE_MIN = sizeof(BlockHeader) - BLOCK_OVERHEAD;
+    static constexpr size_t BLOCK_SIZE_MAX = size_t(1) << FL_INDEX_MAX;
+
+    TlsfAllocator(const TlsfAllocator&);
+
+    //Prevent copies because it might cause errors
+    TlsfAllocator& operator=(const TlsfAllocator&);
+
+    static void mapping(size_t size, size_t& fl, size_t& sl);
+    BlockHeader* findSuitableBlock(size_t size);
+    void insertFreeBlock(BlockHeader* block);
+    void removeFreeBlock(BlockHeader* block);
+    /**
+     * \brief Cut the block after size bytes of payload, the second part is returned without being inserted
+     */
+    static BlockHeader* splitBlock(BlockHeader* block, size_t size);
+
+    uint32_t _fl_bitmap;
+    uint32_t _sl_bitmap[FL_INDEX_COUNT];
+    BlockHeader* _blocks[FL_INDEX_COUNT][SL_INDEX_COUNT];
+};
+
 class PoolAllocator : public Allocator
 {
 public:
@@ -267,6 +329,151 @@ private:
     void** _free_list;
 };
 
+/**
+ * \brief Pool shared by the worker threads, the free objects are linked by index in a lock-free global free list.
+ * The links are kept in their own array of atomics, so reading the link of an object that another thread
+ * just popped never touches the memory of that object. The head packs the index with a tag incremented on every change, so a head popped and pushed back
+ * in between fails the compare and swap (ABA).
+ * Each thread index has its own cache filled and emptied by batches, most allocations touch no shared memory
+ */
+class ConcurrentPoolAllocator : public Allocator
+{
+public:
+
+    ConcurrentPoolAllocator(size_t objectSize, ptr_type objectAlignment, size_t size, void* mem, size_t threadNmb);
+    ~ConcurrentPoolAllocator();
+    /**
+     * \brief Thread-safe without cache, straight from the global free list
+     */
+    void* allocate(size_t size, ptr_type alignment) override;
+    void deallocate(void* p) override;
+    /**
+     * \brief Allocate from the cache of threadIndex, each index must only be used by one thread at a time
+     * (JobSystem::GetCurrentWorkerIndex)
+     */
+    void* allocate(size_t threadIndex);
+    void deallocate(void* p, size_t threadIndex);
+    /**
+     * \brief Give the objects kept in the thread caches back to the global free list, when no thread uses the pool.
+     * The base counters are also brought up to date then
+     */
+    void flushCaches();
+
+    size_t getObjectNmb() const { return _object_nmb; }
+    size_t getAllocatedObjectNmb() const { return _allocated_object_nmb.load(std::memory_order_relaxed); }
+    size_t getUsedMemory() const override { return getAllocatedObjectNmb() * _stride; }
+    size_t getNumAllocations() const override { return getAllocatedObjectNmb(); }
+
+private:
+
+    static constexpr uint32_t INVALID_INDEX = UINT32_MAX;
+    static constexpr size_t CACHE_SIZE = 64;
+    static constexpr size_t CACHE_BATCH = CACHE_SIZE / 2;
+
+    struct alignas(64) ThreadCache
+    {
+        size_t count = 0;
+        uint32_t indexes[CACHE_SIZE];
+    };
+
+    ConcurrentPoolAllocator(const ConcurrentPoolAllocator&);
+
+    //Prevent copies because it might cause errors
+    ConcurrentPoolAllocator& operator=(const ConcurrentPoolAllocator&);
+
+    void* getObject(uint32_t index) const;
+    uint32_t getIndex(const void* p) const;
+    std::atomic<uint32_t>& getNext(uint32_t index) const;
+    uint32_t pop();
+    /**
+     * \brief Push the chain first..last already linked together in one compare and swap
+     */
+    void push(uint32_t first, uint32_t last);
+
+    void* _objects;
+    size_t _stride;
+    size_t _object_nmb;
+    std::atomic<uint64_t> _head;
+    std::atomic<size_t> _allocated_object_nmb;
+    /**
+     * \brief Index of the next free object, for each object in the free list
+     */
+    std::unique_ptr<std::atomic<uint32_t>[]> _links;
+    std::unique_ptr<ThreadCache[]> _caches;
+    size_t _cache_nmb;
+};
+
+/**
+ * \brief Standard allocator drawing from a sfge::Allocator so the STL containers can use the engine arenas.
+ * With a LinearAllocator the memory given back by the container is only reclaimed by clear()
+ */
+template<class T>
+class StlAllocator
+{
+public:
+    using value_type = T;
+    //The containers keep drawing from the same arena when copied, moved or swapped
+    using propagate_on_container_copy_assignment = std::true_type;
+    using propagate_on_container_move_assignment = std::true_type;
+    using propagate_on_container_swap = std::true_type;
+
+    explicit StlAllocator(Allocator& allocator) : _allocator(&allocator) {}
+    template<class U>
+    StlAllocator(const StlAllocator<U>& other) : _allocator(other.getAllocator()) {}
+
+    T* allocate(size_t n)
+    {
+        void* p = _allocator->allocate(n * sizeof(T), alignof(T));
+        if(p == nullptr)
+            throw std::bad_alloc();
+        return static_cast<T*>(p);
+    }
+
+    void deallocate(T* p, size_t n)
+    {
+        (void) n;
+        _allocator->deallocate(p);
+    }
+
+    Allocator* getAllocator() const { return _allocator; }
+
+private:
+    Allocator* _allocator;
+};
+
+template<class T, class U>
+bool operator==(const StlAllocator<T>& lhs, const StlAllocator<U>& rhs)
+{
+    return lhs.getAllocator() == rhs.getAllocator();
+}
+
+template<class T, class U>
+bool operator!=(const StlAllocator<T>& lhs, const StlAllocator<U>& rhs)
+{
+    return !(lhs == rhs);
+}
+
+/**
+ * \brief std::pmr::memory_resource over a sfge::Allocator, to give an engine arena to the std::pmr containers
+ * or to any code taking a polymorphic_allocator.
+ * The blocks are aligned at least on alignof(std::max_align_t), whatever alignment is requested
+ */
+class AllocatorResource : public std::pmr::memory_resource
+{
+public:
+    explicit AllocatorResource(Allocator& allocator) : _allocator(allocator) {}
+
+    Allocator& getAllocator() const { return _allocator; }
+
+protected:
+    void* do_allocate(size_t bytes, size_t alignment) override;
+    void do_deallocate(void* p, size_t bytes, size_t alignment) override;
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override;
+
+private:
+    Allocator& _allocator;
+};
+
 class ProxyAllocator : public Allocator
 {
 public:
@@ -0,0 +1,200 @@
+/*
+MIT License
+
+Copyright (c) 2017 SAE Institute Switzerland AG
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef SFGE_PAGED_VECTOR_H
+#define SFGE_PAGED_VECTOR_H
+
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <utility>
+#include <vector>
+
+namespace sfge
+{
+
+/**
+ * \brief Array of elements stored in fixed-size pages that are never reallocated.
+ * Growing only allocates the new pages, so the elements are not moved and pointers to them stay valid until they are removed
+ */
+template<typename T, size_t PageSize = 1024>
+class PagedVector
+{
+	static_assert(PageSize != 0 && (PageSize & (PageSize - 1)) == 0, "Page size must be a power of two");
+public:
+	using value_type = T;
+	using size_type = size_t;
+	using reference = T&;
+	using const_reference = const T&;
+
+	template<typename TValue, typename TVector>
+	class Iterator
+	{
+	public:
+		using iterator_category = std::random_access_iterator_tag;
+		using value_type = T;
+		using difference_type = std::ptrdiff_t;
+		using pointer = TValue*;
+		using reference = TValue&;
+
+		Iterator(TVector* vector, size_t index) : m_Vector(vector), m_Index(index) {}
+
+		reference operator*() const { return (*m_Vector)[m_Index]; }
+		pointer operator->() const { return &(*m_Vector)[m_Index]; }
+		reference operator[](difference_type offset) const { return (*m_Vector)[m_Index + offset]; }
+		Iterator& operator++() { m_Index++; return *this; }
+		Iterator operator++(int) { auto it = *this; m_Index++; return it; }
+		Iterator& operator--() { m_Index--; return *this; }
+		Iterator operator--(int) { auto it = *this; m_Index--; return it; }
+		Iterator& operator+=(difference_type offset) { m_Index += offset; return *this; }
+		Iterator& operator-=(difference_type offset) { m_Index -= offset; return *this; }
+		Iterator operator+(difference_type offset) const { return Iterator(m_Vector, m_Index + offset); }
+		Iterator operator-(difference_type offset) const { return Iterator(m_Vector, m_Index - offset); }
+		difference_type operator-(const Iterator& other) const
+		{
+			return static_cast<difference_type>(m_Index) - static_cast<difference_type>(other.m_Index);
+		}
+		bool operator==(const Iterator& other) const { return m_Index == other.m_Index; }
+		bool operator!=(const Iterator& other) const { return m_Index != other.m_Index; }
+		bool operator<(const Iterator& other) const { return m_Index < other.m_Index; }
+		bool operator>(const Iterator& other) const { return m_Index > other.m_Index; }
+		bool operator<=(const Iterator& other) const { return m_Index <= other.m_Index; }
+		bool operator>=(const Iterator& other) const { return m_Index >= other.m_Index; }
+	private:
+		TVector* m_Vector;
+		size_t m_Index;
+	};
+	using iterator = Iterator<T, PagedVector>;
+	using const_iterator = Iterator<const T, const PagedVector>;
+
+	static constexpr size_t PAGE_SIZE = PageSize;
+
+	PagedVector() = default;
+	explicit PagedVector(size_t size)
+	{
+		resize(size);
+	}
+	PagedVector(const PagedVector&) = delete;
+	PagedVector& operator=(const PagedVector&) = delete;
+	PagedVector(PagedVector&& other) noexcept :
+		m_Pages(std::move(other.m_Pages)), m_Size(other.m_Size)
+	{
+		other.m_Size = 0;
+	}
+	PagedVector& operator=(PagedVector&& other) noexcept
+	{
+		if (this != &other)
+		{
+			clear();
+			m_Pages = std::move(other.m_Pages);
+			m_Size = other.m_Size;
+			other.m_Size = 0;
+		}
+		return *this;
+	}
+	~PagedVector()
+	{
+		clear();
+	}
+
+	T& operator[](size_t index)
+	{
+		return *reinterpret_cast<T*>(&m_Pages[index / PageSize][index % PageSize]);
+	}
+	const T& operator[](size_t index) const
+	{
+		return *reinterpret_cast<const T*>(&m_Pages[index / PageSize][index % PageSize]);
+	}
+	T& back() { return (*this)[m_Size - 1]; }
+	const T& back() const { return (*this)[m_Size - 1]; }
+
+	size_t size() const { return m_Size; }
+	bool empty() const { return m_Size == 0; }
+	size_t capacity() const { return m_Pages.size() * PageSize; }
+
+	template<typename... Args>
+	T& emplace_back(Args&&... args)
+	{
+		if (m_Size == capacity())
+		{
+			m_Pages.push_back(std::unique_ptr<Slot[]>(new Slot[PageSize]));
+		}
+		auto* element = new (&m_Pages[m_Size / PageSize][m_Size % PageSize]) T(std::forward<Args>(args)...);
+		m_Size++;
+		return *element;
+	}
+	void push_back(const T& value) { emplace_back(value); }
+	void push_back(T&& value) { emplace_back(std::move(value)); }
+	void pop_back()
+	{
+		m_Size--;
+		(*this)[m_Size].~T();
+	}
+	/**
+	 * \brief Default construct or destroy the elements at the end, the pages are kept for the next growth
+	 */
+	void resize(size_t size)
+	{
+		reserve(size);
+		while (m_Size < size)
+		{
+			emplace_back();
+		}
+		while (m_Size > size)
+		{
+			pop_back();
+		}
+	}
+	void reserve(size_t size)
+	{
+		while (capacity() < size)
+		{
+			m_Pages.push_back(std::unique_ptr<Slot[]>(new Slot[PageSize]));
+		}
+	}
+	void clear()
+	{
+		while (m_Size > 0)
+		{
+			pop_back();
+		}
+	}
+
+	iterator begin() { return iterator(this, 0); }
+	iterator end() { return iterator(this, m_Size); }
+	const_iterator begin() const { return const_iterator(this, 0); }
+	const_iterator end() const { return const_iterator(this, m_Size); }
+private:
+	struct alignas(T) Slot
+	{
+		unsigned char bytes[sizeof(T)];
+	};
+	std::vector<std::unique_ptr<Slot[]>> m_Pages;
+	size_t m_Size = 0;
+};
+
+}
+
+#endif
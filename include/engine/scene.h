@@ -29,6 +29,7 @@
 #include <memory>
 #include <string>
 #include <list>
+#include <functional>
 
 #include <engine/system.h>
 #include <utility/json_utility.h>
@@ -38,7 +39,7 @@
 
 namespace sfge
 {
-enum class ComponentType: int;
+enum class ComponentType: std::uint64_t;
 class IComponentFactory;
 class PySystem;
 
@@ -47,6 +48,19 @@ namespace editor
 struct SceneInfo;
 }
 
+/**
+ * \brief Entity template compiled once from the json of a scene entity, then instantiated many times with SceneManager::InstantiatePrefab
+ */
+struct Prefab
+{
+	std::string name;
+	/**
+	 * \brief Json of each component, in the order of the file
+	 */
+	std::vector<json> components;
+	std::vector<ComponentType> componentTypes;
+};
+
 /**
 * \brief The Scene Manager do the transition between two scenes, read from the Engine Configuration the scenes build list
 */
@@ -81,6 +95,23 @@ public:
 	std::list<std::string> GetAllScenes();
 
 	void AddComponentManager(IComponentFactory* componentFactory, ComponentType componentType);
+	/**
+	 * \return The manager of the component type, nullptr when no manager is registered for it
+	 */
+	IComponentFactory* GetComponentFactory(ComponentType componentType);
+
+	/**
+	 * \brief Check the components of the entity json, in the same format as the entities of a scene, and keep them in a prefab
+	 */
+	Prefab CompilePrefab(const json& entityJson);
+	Prefab LoadPrefabFromPath(const std::string& prefabPath);
+	/**
+	 * \brief Allocate count entities at once and create each component of the prefab for all of them in one pass per component type
+	 * \param initializer Called with each new entity and its number in the wave, after all the components are created
+	 * \return The new entities, fewer than count when the entities run out
+	 */
+	std::vector<Entity> InstantiatePrefab(Prefab& prefab, size_t count,
+		const std::function<void(Entity, size_t)>& initializer = nullptr);
 
 	void OnUpdate(float dt) override;
 	void OnFixedUpdate() override;
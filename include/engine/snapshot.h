@@ -0,0 +1,144 @@
+/*
+MIT License
+
+Copyright (c) 2017 SAE Institute Switzerland AG
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef SFGE_SNAPSHOT_H
+#define SFGE_SNAPSHOT_H
+
+#include <cstddef>
+#include <cstring>
+#include <type_traits>
+#include <vector>
+
+namespace sfge
+{
+
+/**
+ * \brief Binary copy of the simulation state, the systems read it back in the order they wrote it.
+ * Each value is aligned in the buffer so the arrays can be read in place without copying them
+ */
+class Snapshot
+{
+public:
+	/**
+	 * \brief Empty the buffer but keep its memory to write the next snapshot without allocating
+	 */
+	void Clear()
+	{
+		m_Buffer.clear();
+		m_ReadPosition = 0;
+	}
+	/**
+	 * \brief Start reading from the beginning, each restore of the same snapshot calls it
+	 */
+	void Rewind()
+	{
+		m_ReadPosition = 0;
+	}
+	size_t Size() const
+	{
+		return m_Buffer.size();
+	}
+	bool IsEmpty() const
+	{
+		return m_Buffer.empty();
+	}
+
+	template<typename T>
+	void Write(const T& value)
+	{
+		WriteArray(&value, 1);
+	}
+	/**
+	 * \brief Write the number of values then the raw values
+	 */
+	template<typename T>
+	void WriteArray(const T* values, size_t count)
+	{
+		static_assert(std::is_trivially_copyable<T>::value, "Only raw data can be written in a snapshot");
+		Align(alignof(size_t));
+		Append(&count, sizeof(size_t));
+		Align(alignof(T));
+		Append(values, sizeof(T) * count);
+	}
+	template<typename T>
+	T Read()
+	{
+		size_t count = 0;
+		const T* value = ReadArray<T>(count);
+		return count == 1 ? *value : T();
+	}
+	/**
+	 * \return Pointer to the values inside the buffer, valid until the next write
+	 */
+	template<typename T>
+	const T* ReadArray(size_t& count)
+	{
+		static_assert(std::is_trivially_copyable<T>::value, "Only raw data can be read from a snapshot");
+		Skip(alignof(size_t));
+		if (m_ReadPosition + sizeof(size_t) > m_Buffer.size())
+		{
+			count = 0;
+			return nullptr;
+		}
+		std::memcpy(&count, m_Buffer.data() + m_ReadPosition, sizeof(size_t));
+		m_ReadPosition += sizeof(size_t);
+		Skip(alignof(T));
+		if (m_ReadPosition + sizeof(T) * count > m_Buffer.size())
+		{
+			count = 0;
+			return nullptr;
+		}
+		const auto* values = reinterpret_cast<const T*>(m_Buffer.data() + m_ReadPosition);
+		m_ReadPosition += sizeof(T) * count;
+		return values;
+	}
+private:
+	void Align(size_t alignment)
+	{
+		m_Buffer.resize((m_Buffer.size() + alignment - 1) / alignment * alignment);
+	}
+	void Skip(size_t alignment)
+	{
+		m_ReadPosition = (m_ReadPosition + alignment - 1) / alignment * alignment;
+	}
+	void Append(const void* data, size_t size)
+	{
+		const auto position = m_Buffer.size();
+		m_Buffer.resize(position + size);
+		if (size > 0)
+		{
+			std::memcpy(m_Buffer.data() + position, data, size);
+		}
+	}
+
+	/**
+	 * \brief Allocated with new so the start is aligned for any raw value
+	 */
+	std::vector<unsigned char> m_Buffer;
+	size_t m_ReadPosition = 0;
+};
+
+}
+
+#endif
@@ -29,6 +29,8 @@ namespace sfge
 {
 
 class Engine;
+class LinearAllocator;
+class AllocatorResource;
 struct ColliderData;
 /**
 * \brief Systems are classes used by the Engine to init and update features, new features can be added through PySystem
@@ -80,6 +82,11 @@ public:
 	bool GetEnable() const;
 
 	Engine& GetEngine() const;
+	/**
+	* \brief Per-frame scratch memory of the calling thread, for the transient containers of an update
+	*/
+	LinearAllocator& GetFrameAllocator() const;
+	AllocatorResource& GetFrameResource() const;
 	bool GetInitlialized() const;
 protected:
 	bool m_Enable = true;
@@ -0,0 +1,91 @@
+/*
+MIT License
+
+Copyright (c) 2017 SAE Institute Switzerland AG
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef SFGE_TASK_GRAPH_H
+#define SFGE_TASK_GRAPH_H
+
+#include <functional>
+#include <string>
+#include <vector>
+
+#include <engine/entity.h>
+#include <engine/job_system.h>
+
+namespace sfge
+{
+
+using TaskId = unsigned;
+/**
+ * \brief Mask used by the tasks touching every component type, like the python systems
+ */
+const EntityMask ALL_COMPONENTS_MASK = ~EntityMask(0);
+
+/**
+ * \brief Frame graph of the systems updates. Each task declares the component types it reads and writes,
+ * two tasks conflicting on a component type keep their insertion order, the others run in parallel on the job system
+ */
+class TaskGraph
+{
+public:
+	/**
+	 * \brief Add a task to the graph, the insertion order is the execution order of conflicting tasks
+	 * \param mainThread Tasks using the window, ImGui or the python interpreter must stay on the main thread
+	 */
+	TaskId AddTask(const std::string& name, std::function<void()> task,
+		EntityMask readMask, EntityMask writeMask, bool mainThread = false);
+	/**
+	 * \brief Sort the tasks in waves of independent tasks, called once after all the tasks are added
+	 */
+	void Build();
+	/**
+	 * \brief Execute all the waves, the main thread tasks are run on the calling thread while the others are scheduled as jobs
+	 */
+	void Execute(JobSystem& jobSystem);
+	void Clear();
+
+	size_t GetTaskNmb() const;
+	size_t GetWaveNmb() const;
+	/**
+	 * \brief Index of the wave running the task after Build, tasks in the same wave run in parallel
+	 */
+	size_t GetTaskWave(TaskId taskId) const;
+private:
+	struct Task
+	{
+		std::string name;
+		std::function<void()> function;
+		EntityMask readMask = 0;
+		EntityMask writeMask = 0;
+		bool mainThread = false;
+	};
+	static bool IsConflicting(const Task& task, const Task& otherTask);
+	static void RunTask(const Task& task);
+
+	std::vector<Task> m_Tasks;
+	std::vector<std::vector<TaskId>> m_Waves;
+	std::vector<size_t> m_TaskWaves;
+};
+
+}
+#endif
@@ -25,12 +25,18 @@
 #ifndef SFGE_TRANSFORM_H_
 #define SFGE_TRANSFORM_H_
 
+#include <limits>
+
+#include <SFML/Graphics/Transform.hpp>
+
 #include <engine/entity.h>
 #include <engine/component.h>
 #include <engine/vector.h>
+#include <engine/transform2d_soa.h>
 
 namespace sfge
 {
+class Snapshot;
 
 
 struct Transform2d
@@ -40,6 +46,18 @@ struct Transform2d
 	float EulerAngle = 0.0f;
 };
 
+inline bool operator==(const Transform2d& transform1, const Transform2d& transform2)
+{
+	return transform1.Position == transform2.Position &&
+		transform1.Scale == transform2.Scale &&
+		transform1.EulerAngle == transform2.EulerAngle;
+}
+
+inline bool operator!=(const Transform2d& transform1, const Transform2d& transform2)
+{
+	return !(transform1 == transform2);
+}
+
 namespace editor
 {
 struct Transform2dInfo : ComponentInfo
@@ -49,17 +67,191 @@ struct Transform2dInfo : ComponentInfo
 };
 }
 
+/**
+ * \brief Handle on the transform of an entity with both storages of the Transform2dManager.
+ * The storage is looked up at each access, so the handle stays valid when other transforms are added or removed
+ */
+class Transform2dRef
+{
+public:
+	Transform2dRef(Transform2dManager* transformManager, Entity entity);
+	/**
+	 * \return false when the entity has no transform
+	 */
+	bool IsValid() const;
+	Entity GetEntity() const;
+	Transform2d Get() const;
+	void Set(const Transform2d& transform);
+	Vec2f GetPosition() const;
+	void SetPosition(Vec2f position);
+	Vec2f GetScale() const;
+	void SetScale(Vec2f scale);
+	float GetEulerAngle() const;
+	void SetEulerAngle(float eulerAngle);
+private:
+	Transform2dManager* m_TransformManager;
+	Entity m_Entity;
+};
+
+/**
+ * \brief Manager of the transforms, stored as Transform2d structs in the sparse set of the components,
+ * or with Configuration::transformSoA in one array per field so the systems run the Transform2dSoA kernels on them in place.
+ * GetComponentRef, GetLocalTransform and SetLocalTransform work with both storages
+ */
 class Transform2dManager :
 	public SingleComponentManager<Transform2d, editor::Transform2dInfo, ComponentType::TRANSFORM2D>
 {
 public:
+	static constexpr size_t INVALID_SOA_INDEX = std::numeric_limits<size_t>::max();
+
 	using SingleComponentManager::SingleComponentManager;
+	void OnEngineInit() override;
+	/**
+	 * \return The new transform, nullptr with the SoA storage where it is reached with GetComponentRef
+	 */
 	Transform2d* AddComponent(Entity entity) override;
 	void CreateComponent(json& componentJson, Entity entity) override;
+	void CreateComponents(json& componentJson, const std::vector<Entity>& entities) override;
 	void DestroyComponent(Entity entity) override;
 	void OnUpdate(float dt) override;
+	void OnResize(size_t newSize) override;
+	void OnDestroy(Entity entity) override;
+	void OnBeforeSceneLoad() override;
+	/**
+	 * \brief Handle on the transform of the entity, used instead of GetComponentPtr that is nullptr with the SoA storage
+	 */
+	Transform2dRef GetComponentRef(Entity entity);
+	bool HasTransform(Entity entity) const;
+	/**
+	 * \brief Transform of the entity relative to its parent, a default transform when it has none
+	 */
+	Transform2d GetLocalTransform(Entity entity) const;
+	void SetLocalTransform(Entity entity, const Transform2d& transform);
+	/**
+	 * \brief Arrays of the transforms with the SoA storage, nullptr with the Transform2d structs.
+	 * The changes made in place are detected by the next OnUpdate like the other ones
+	 */
+	Transform2dSoA* GetSoA();
+	/**
+	 * \return Index of the transform of the entity in the arrays of GetSoA, INVALID_SOA_INDEX when it has none
+	 */
+	size_t GetSoAIndex(Entity entity) const;
+	/**
+	 * \brief Attach the entity to a parent, its transform becomes relative to the parent one
+	 * \param parent INVALID_ENTITY detaches the entity, it keeps its local transform as world transform
+	 * \return false when the parent is the entity itself or one of its children
+	 */
+	bool SetParent(Entity entity, Entity parent);
+	Entity GetParent(Entity entity) const;
+	/**
+	 * \brief Transform of the entity in the world, the same as its component when it has no parent.
+	 * Children transforms are computed at the end of OnUpdate
+	 */
+	Transform2d GetWorldTransform(Entity entity) const;
+	sf::Transform GetWorldMatrix(Entity entity) const;
+	/**
+	 * \brief Convert a world position to the position relative to the parent of the entity
+	 */
+	Vec2f WorldToLocalPosition(Entity entity, Vec2f worldPosition) const;
+	/**
+	 * \brief Write the transforms and the previous fixed update transforms used by the interpolation
+	 */
+	void SaveSnapshot(Snapshot& snapshot);
+	void RestoreSnapshot(Snapshot& snapshot);
+	/**
+	 * \brief Keep a copy of the current transforms, called by the Engine before each fixed update
+	 */
+	void StorePreviousTransforms();
+	/**
+	 * \brief Blend the transform of the entity between the previous and the current fixed update
+	 * \param alpha The ratio between the two fixed updates, 0 gives the previous transform and 1 the current one
+	 */
+	Transform2d GetInterpolatedTransform(Entity entity, float alpha) const;
+	/**
+	 * \brief World transform of the entity from the interpolated transforms of its ancestors and of itself,
+	 * so the children move smoothly with their interpolated parent
+	 */
+	Transform2d GetInterpolatedWorldTransform(Entity entity, float alpha) const;
+	/**
+	 * \brief Counter incremented by each OnUpdate, starting from 1 so a version of 0 means never seen
+	 */
+	unsigned GetFrameVersion() const;
+	/**
+	 * \brief Frame version of the last OnUpdate where the transform of the entity, or its interpolation, changed.
+	 * Systems keep the last version they processed and skip the entity while it stays the same
+	 */
+	unsigned GetChangeVersion(Entity entity) const;
+protected:
+	friend class Transform2dRef;
+
+	void ResizeTransformArrays(size_t newSize);
+	/**
+	 * \brief Remove the transform and its info from the storage in use
+	 */
+	void RemoveTransform(Entity entity);
+	/**
+	 * \brief Update the change version of the entity when its transform, or its interpolation, changed since the last OnUpdate
+	 */
+	void CheckTransformChange(Entity entity, const Transform2d& transform, bool interpolate);
+	/**
+	 * \brief Call function with the entity and its transform, for every transform of the storage in use
+	 */
+	template<typename F>
+	void ForEachTransform(const F& function)
+	{
+		if (m_SoAStorage)
+		{
+			for (size_t i = 0; i < m_SoA.Size(); i++)
+			{
+				function(m_SoA.GetEntity(i), m_SoA.Get(i));
+			}
+			return;
+		}
+		m_Components.ForEach([&function](Entity entity, const Transform2d& transform)
+		{
+			function(entity, transform);
+		});
+	}
+	void DetachFromHierarchy(Entity entity);
+	/**
+	 * \brief Sort the entities of the hierarchies by depth so each parent comes before its children
+	 */
+	void SortHierarchy();
+	/**
+	 * \brief Compute the world transforms of the children whose transform or parent changed this frame
+	 */
+	void UpdateWorldTransforms();
+
+	std::vector<Transform2d> m_PreviousComponents{ INIT_ENTITY_NMB };
+	std::vector<bool> m_PreviousValid = std::vector<bool>(INIT_ENTITY_NMB, false);
+	unsigned m_FrameVersion = 0;
+	std::vector<Transform2d> m_LastTransforms{ INIT_ENTITY_NMB };
+	std::vector<unsigned> m_ChangeVersions = std::vector<unsigned>(INIT_ENTITY_NMB, 0U);
+
+	std::vector<Entity> m_Parents = std::vector<Entity>(INIT_ENTITY_NMB, INVALID_ENTITY);
+	std::vector<Transform2d> m_WorldTransforms{ INIT_ENTITY_NMB };
+	std::vector<sf::Transform> m_WorldMatrices{ INIT_ENTITY_NMB };
+	std::vector<unsigned> m_WorldVersions = std::vector<unsigned>(INIT_ENTITY_NMB, 0U);
+	/**
+	 * \brief Children and the roots of their hierarchies, sorted by depth
+	 */
+	std::vector<Entity> m_HierarchyOrder;
+	std::vector<Entity> m_Children;
+	bool m_HierarchyDirty = false;
+
+	bool m_SoAStorage = false;
+	Transform2dSoA m_SoA;
+	/**
+	 * \brief Index of the transform of each entity in m_SoA, the last transform is moved in the place of a removed one
+	 */
+	std::vector<size_t> m_SoAIndexes = std::vector<size_t>(INIT_ENTITY_NMB, INVALID_SOA_INDEX);
+
+	std::vector<Entity> m_SnapshotEntities;
+	std::vector<Transform2d> m_SnapshotTransforms;
 };
 
+SFGE_COMPONENT_TRAITS(Transform2d, Transform2dManager, ComponentType::TRANSFORM2D)
+
 }
 
 #endif /* INCLUDE_ENGINE_TRANSFORM_H_ */
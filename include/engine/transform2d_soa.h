@@ -0,0 +1,104 @@
+/*
+MIT License
+
+Copyright (c) 2017 SAE Institute Switzerland AG
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef SFGE_TRANSFORM2D_SOA_H
+#define SFGE_TRANSFORM2D_SOA_H
+
+#include <vector>
+
+#include <engine/globals.h>
+#include <engine/vector.h>
+
+namespace sfge
+{
+struct Transform2d;
+
+/**
+ * \brief Bring an angle in degrees back into [-180, 180] after it went over by less than a turn
+ */
+inline float WrapAngle(float angle)
+{
+	if (angle > 180.0f)
+	{
+		angle -= 360.0f;
+	}
+	if (angle < -180.0f)
+	{
+		angle += 360.0f;
+	}
+	return angle;
+}
+/**
+ * \brief WrapAngle on every angle, four at a time with SSE
+ */
+void WrapAngles(float* angles, size_t count);
+/**
+ * \brief Add the same delta to every position
+ */
+void TranslatePositions(float* positionsX, float* positionsY, size_t count, Vec2f delta);
+/**
+ * \brief Move every position by its velocity during dt
+ */
+void IntegratePositions(float* positionsX, float* positionsY,
+	const float* velocitiesX, const float* velocitiesY, size_t count, float dt);
+
+/**
+ * \brief Structure of arrays of transforms for systems updating many of them in bulk (particles, bullets, the planets of PlanetSystem...),
+ * also the storage of Transform2dManager with Configuration::transformSoA.
+ * Each field is stored in its own array so the kernels above process them with SIMD.
+ * Get and Set convert from and to the Transform2d used by the components
+ */
+class Transform2dSoA
+{
+public:
+	size_t Add(Entity entity, const Transform2d& transform);
+	/**
+	 * \brief Remove the transform by moving the last one in its place
+	 */
+	void Remove(size_t index);
+	void Clear();
+	void Reserve(size_t capacity);
+	size_t Size() const;
+
+	Transform2d Get(size_t index) const;
+	void Set(size_t index, const Transform2d& transform);
+	Entity GetEntity(size_t index) const;
+	const std::vector<Entity>& GetEntities() const;
+
+	void WrapAngles();
+	void Translate(Vec2f delta);
+	void Integrate(const float* velocitiesX, const float* velocitiesY, float dt);
+
+	std::vector<float> positionsX;
+	std::vector<float> positionsY;
+	std::vector<float> scalesX;
+	std::vector<float> scalesY;
+	std::vector<float> angles;
+private:
+	std::vector<Entity> m_Entities;
+};
+
+}
+
+#endif
@@ -29,6 +29,7 @@ SOFTWARE.
 #include <graphics/shape2d.h>
 #include <graphics/texture.h>
 #include <graphics/sprite2d.h>
+#include <graphics/render_pipeline.h>
 
 namespace sfge
 {
@@ -47,13 +48,22 @@ public:
 	void OnEngineInit() override;
 
 	/**
-		* \brief Update the Graphics Manager and prepare for the rendering
+		* \brief Clear the window before the rendering, the sprites and shapes are updated by the Engine frame graph
 		* \param dt Delta time since last frame
 		*/
 	void OnUpdate(float dt) override;
 	void OnDraw() override;
 	void Display();
 	/**
+	* \brief Copy the sprites and shapes in a snapshot and hand it to the render thread, only used with pipelinedRendering
+	*/
+	void PublishSnapshot();
+	bool IsPipelined() const;
+	/**
+	* \brief Stop the render thread before closing the window it is drawing on
+	*/
+	void CloseWindow();
+	/**
 	* \brief Destroy the window and other
 	*/
 	void Destroy() override;
@@ -63,6 +73,9 @@ public:
 	void OnAfterSceneLoad() override;
 
 
+	/**
+	* \brief Immediate debug drawing on the window, does nothing without window or with pipelinedRendering
+	*/
 	void DrawLine(Vec2f from, Vec2f to, sf::Color color=sf::Color::Red);
     void DrawVector(Vec2f drawingVector, Vec2f originPos, sf::Color color=sf::Color::Red);
 	/**
@@ -77,6 +90,7 @@ public:
 
 protected:
 	bool m_Windowless = false;
+	bool m_Pipelined = false;
 	/**
 	* \brief Write to log the OpenGL version
 	*/
@@ -85,6 +99,7 @@ protected:
 	SpriteManager m_SpriteManager{m_Engine};
 	ShapeManager m_ShapeManager{m_Engine};
 	std::unique_ptr<sf::RenderWindow> m_Window;
+	RenderPipeline m_RenderPipeline;
 
 	const float debugVectorPixelResolution = 20.f;
 };
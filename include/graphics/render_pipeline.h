@@ -0,0 +1,106 @@
+/*
+MIT License
+
+Copyright (c) 2017 SAE Institute Switzerland AG
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef SFGE_RENDER_PIPELINE_H
+#define SFGE_RENDER_PIPELINE_H
+
+#include <array>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <SFML/Graphics.hpp>
+
+namespace sfge
+{
+
+/**
+ * \brief Immutable copy of what is drawn in a frame, written by the simulation thread and read by the render thread
+ */
+struct RenderSnapshot
+{
+	/**
+	 * \brief Sprites with their texture rect, color and transform, drawn before the shapes like the main thread drawing
+	 */
+	std::vector<sf::Sprite> sprites;
+	/**
+	 * \brief Filled shapes already transformed in world space, drawn in one batch of sf::Triangles
+	 */
+	std::vector<sf::Vertex> shapeVertices;
+
+	void Clear();
+};
+
+/**
+ * \brief Render thread drawing the last published snapshot while the simulation computes the next one.
+ * The three snapshots are owned in turn by the simulation (write), the render thread (read) and the hand-off slot (ready).
+ */
+class RenderPipeline
+{
+public:
+	RenderPipeline() = default;
+	~RenderPipeline();
+	RenderPipeline(const RenderPipeline&) = delete;
+	RenderPipeline& operator=(const RenderPipeline&) = delete;
+
+	/**
+	 * \brief Give the OpenGL context of the window to the render thread, the events must still be polled on the calling thread
+	 */
+	void Start(sf::RenderWindow* window);
+	/**
+	 * \brief Draw the pending snapshot, join the render thread and give back the OpenGL context to the calling thread
+	 */
+	void Stop();
+	bool IsRunning() const;
+
+	RenderSnapshot& GetWriteSnapshot();
+	/**
+	 * \brief Hand the write snapshot to the render thread, waiting while it did not pick up the previous one
+	 */
+	void Publish();
+	/**
+	 * \brief Wait until the render thread drew everything published, used before releasing the textures
+	 */
+	void WaitIdle();
+private:
+	void RenderLoop();
+	void Draw(const RenderSnapshot& snapshot) const;
+
+	std::array<RenderSnapshot, 3> m_Snapshots;
+	size_t m_WriteIndex = 0;
+	size_t m_ReadyIndex = 1;
+	size_t m_ReadIndex = 2;
+	bool m_HasNewSnapshot = false;
+	bool m_IsDrawing = false;
+	bool m_Running = false;
+
+	std::mutex m_Mutex;
+	std::condition_variable m_Condition;
+	std::thread m_Thread;
+	sf::RenderWindow* m_Window = nullptr;
+};
+
+}
+#endif
@@ -31,6 +31,7 @@ SOFTWARE.
 #include <engine/component.h>
 #include <engine/transform2d.h>
 #include <editor/editor.h>
+#include <graphics/render_pipeline.h>
 //Externals
 #include <SFML/Graphics.hpp>
 
@@ -53,15 +54,22 @@ public:
 	Shape(Transform2d* transform, sf::Vector2f offset);
   	Shape ( Shape && ) = default; //move constructor
   	Shape ( const Shape & ) = delete; //delete copy constructor
+  	Shape& operator=(Shape&&) = default; //move assignment used by the sparse set removal
   	virtual ~Shape();
 	void Draw(sf::RenderWindow& window) const;
 	void SetFillColor(sf::Color color) const;
 	void Update() const;
+	void AppendTriangles(std::vector<sf::Vertex>& vertices) const;
 	void SetShape(std::unique_ptr<sf::Shape> shape);
 	sf::Shape* GetShape();
+	void SetOffset(sf::Vector2f offset) override;
 protected:
 	friend class ShapeManager;
 	Transform2d transform;
+	/**
+	 * \brief Change version of the transform last applied to the shape, 0 forces the next update
+	 */
+	unsigned transformVersion = 0;
 	std::unique_ptr<sf::Shape> m_Shape = nullptr;
 	Entity entity = INVALID_ENTITY;
 };
@@ -88,6 +96,10 @@ public:
 
 	void OnEngineInit() override;
 	void DrawShapes(sf::RenderWindow &window);
+	/**
+	* \brief Append the filled shapes as world space triangles in the snapshot drawn by the render thread
+	*/
+	void FillSnapshot(RenderSnapshot& snapshot);
 	void OnUpdate(float dt) override;
 	void OnBeforeSceneLoad() override;
 
@@ -100,6 +112,8 @@ protected:
 	Transform2dManager* m_Transform2dManager;
 };
 
+SFGE_COMPONENT_TRAITS(Shape, ShapeManager, ComponentType::SHAPE2D)
+
 
 
 }
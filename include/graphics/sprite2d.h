@@ -34,6 +34,7 @@ SOFTWARE.
 #include <engine/transform2d.h>
 #include <editor/editor.h>
 #include <graphics/texture.h>
+#include <graphics/render_pipeline.h>
 
 namespace sfge
 {
@@ -53,9 +54,14 @@ public:
 	void Update();
 	void Draw(sf::RenderWindow& window);
 	void SetTexture(sf::Texture* newTexture);
+	void SetOffset(sf::Vector2f offset) override;
 protected:
 	friend class SpriteManager;
 	Transform2d transform;
+	/**
+	 * \brief Change version of the transform last applied to the sprite, 0 forces the next update
+	 */
+	unsigned transformVersion = 0;
 	sf::Sprite sprite;
 };
 
@@ -83,11 +89,19 @@ public:
 	void OnEngineInit() override;
 	void OnUpdate(float dt) override;
 	void DrawSprites(sf::RenderWindow &window);
+	/**
+	* \brief Copy the sprites in the snapshot drawn by the render thread, in the same order as DrawSprites
+	*/
+	void FillSnapshot(RenderSnapshot& snapshot);
 
 	void OnBeforeSceneLoad() override;
 	void OnAfterSceneLoad() override;
 	Sprite* AddComponent(Entity entity) override;
 	void CreateComponent(json& componentJson, Entity entity) override;
+	/**
+	 * \brief Load the texture once and copy the first sprite to the other entities
+	 */
+	void CreateComponents(json& componentJson, const std::vector<Entity>& entities) override;
 	void DestroyComponent(Entity entity) override;
 
 	void OnResize(size_t new_size) override;
@@ -96,6 +110,8 @@ protected:
 	Transform2dManager* m_Transform2dManager = nullptr;
 };
 
+SFGE_COMPONENT_TRAITS(Sprite, SpriteManager, ComponentType::SPRITE2D)
+
 
 
 
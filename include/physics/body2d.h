@@ -64,7 +64,7 @@ struct Body2dInfo : ComponentInfo
 	Body2dManager* bodyManager = nullptr;
 private:
 	std::deque<b2Vec2> m_Velocities;
-	const size_t m_VelocitiesMaxSize = 120;
+	static const size_t m_VelocitiesMaxSize = 120;
 };
 }
 
@@ -77,14 +77,37 @@ public:
 	Body2d* AddComponent(Entity entity) override;
 	void CreateComponent(json& componentJson, Entity entity) override;
 	void DestroyComponent(Entity entity) override;
+	/**
+	 * \brief Destroy the b2Body of the entity before removing its component
+	 */
+	void OnDestroy(Entity entity) override;
+	void OnBeforeSceneLoad() override;
 
 	void OnResize(size_t new_size) override;
+	/**
+	 * \brief Write the position, angle and velocities of each b2Body
+	 */
+	void SaveSnapshot(Snapshot& snapshot);
+	void RestoreSnapshot(Snapshot& snapshot);
 
 private:
+	struct BodyState
+	{
+		Entity entity;
+		b2Vec2 position;
+		float angle;
+		b2Vec2 linearVelocity;
+		float angularVelocity;
+		bool awake;
+	};
+	std::vector<BodyState> m_SnapshotBodies;
+
 	Transform2dManager* m_Transform2dManager;
 	std::weak_ptr<b2World> m_WorldPtr;
 };
 
+SFGE_COMPONENT_TRAITS(Body2d, Body2dManager, ComponentType::BODY2D)
+
 
 
 }
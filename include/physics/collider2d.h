@@ -71,6 +71,8 @@ protected:
 	Body2dManager* m_BodyManager = nullptr;
 };
 
+SFGE_COMPONENT_TRAITS(ColliderData, ColliderManager, ComponentType::COLLIDER2D)
+
 }
 
 #endif
\ No newline at end of file
@@ -33,6 +33,8 @@
 namespace sfge
 {
 
+class Snapshot;
+
 using InstanceId = unsigned;
 using ModuleId = unsigned;
 class PySystem : public System
@@ -46,6 +48,21 @@ public:
 	void OnEditorDraw() override;
 	void OnContact(ColliderData* c1, ColliderData* c2, bool enter) override;
 	std::string GetPySystemName();
+	/**
+	 * \brief Call the optional save_state method of the python system, returning its state as bytes
+	 * \return false when the system has no save_state method
+	 */
+	bool SaveState(std::string& state);
+	/**
+	 * \brief Give back the bytes of save_state to the optional restore_state method
+	 */
+	void RestoreState(const std::string& state);
+	/**
+	 * \brief Component types declared by the optional read_components and write_components lists of the python system,
+	 * a system without them touches all the component types. A system declaring them can run next to the worker tasks of the update graph:
+	 * in its update, the bindings refuse to create entities or add components and destroy_entity waits for the sync point
+	 */
+	void GetComponentAccess(EntityMask& readMask, EntityMask& writeMask);
 };
 
 class PySystemManager : public System
@@ -63,6 +80,8 @@ public:
 
 	PySystem* GetPySystemFromClassName(std::string className);
 	std::vector<PySystem*>& GetPySystems();
+	void SaveSnapshot(Snapshot& snapshot);
+	void RestoreSnapshot(Snapshot& snapshot);
 protected:
 	std::vector<PySystem*> m_PySystems{ INIT_ENTITY_NMB * MULTIPLE_COMPONENTS_MULTIPLIER };
 	std::vector<std::string> m_PySystemNames {INIT_ENTITY_NMB * MULTIPLE_COMPONENTS_MULTIPLIER};
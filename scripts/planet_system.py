@@ -10,6 +10,7 @@ texture_manager = graphics2d_manager.texture_manager
 class PlanetSystem(System):
     screen_size: Vector2f
     entity_nmb = None  # type: int
+    entities = None  # type: list
     center_mass = 1000.0
     planet_mass = 1.0
     gravity_const = 1000.0
@@ -19,17 +20,17 @@ class PlanetSystem(System):
         self.screen_size = engine.config.screen_size
         entity_manager.resize(self.entity_nmb)
 
-        for i in range(self.entity_nmb):
-            new_entity = entity_manager.create_entity(i+1)
-
-            transform = transform2d_manager.add_component(new_entity)  # type: Transform2d
+        # The planets share the texture and are created in one pass per component type
+        planet_prefab = scene_manager.load_prefab("data/prefabs/planet.prefab")
+        self.entities = scene_manager.instantiate_prefab(planet_prefab, self.entity_nmb)
+        for new_entity in self.entities:
+            transform = transform2d_manager.get_component(new_entity)  # type: Transform2d
             transform.position = Vec2f(random.randint(0, self.screen_size.x), random.randint(0, self.screen_size.y))
 
+            # The body starts at the transform position, so it is added after the position is set
             body2d = body2d_manager.add_component(new_entity)  # type: Body2d
             body2d.velocity = self.calculate_init_speed(transform)
 
-            sprite_manager.create_component(new_entity, "data/sprites/round.png")
-
     def calculate_init_speed(self, transform):
         delta_to_center = self.screen_size / 2.0 - transform.position
 
@@ -50,8 +51,8 @@ class PlanetSystem(System):
         return Physics2dManager.pixel2meter(delta_to_center / delta_to_center.magnitude * force)
 
     def fixed_update(self):
-        for i in range(self.entity_nmb):
-            transform = transform2d_manager.get_component(i+1)  # type: Transform2d
+        for entity in self.entities:
+            transform = transform2d_manager.get_component(entity)  # type: Transform2d
 
-            body2d = body2d_manager.get_component(i+1)  # type: Body2d
+            body2d = body2d_manager.get_component(entity)  # type: Body2d
             body2d.apply_force(self.calculate_new_force(transform))
@@ -3,15 +3,15 @@ from SFGE import *
 
 class StayOnscreenSystem(System):
 
-    bodies_entites: list
+    bodies_query: EntityQuery
 
     def init(self):
-        self.bodies_entites = entity_manager.get_entities_with_type(System.Body)
+        self.bodies_query = entity_manager.get_query([System.Body, System.Transform2d])
 
     def fixed_update(self):
         config = engine.config
         screen_size = config.screen_size
-        for entity in self.bodies_entites:
+        for entity in self.bodies_query:
             transform = transform2d_manager.get_component(entity)
             body: Body2d = physics2d_manager.body2d_manager.get_component(entity)
 
@@ -58,7 +58,8 @@ void Editor::OnEngineInit()
 	m_Config = m_Engine.GetConfig();
 	m_Enable = m_Config == nullptr || m_Config->editor;
 	m_KeyboardManager = &m_Engine.GetInputManager()->GetKeyboardManager();
-	m_Window = m_GraphicsManager->GetWindow();
+	//ImGui needs the OpenGL context owned by the render thread in pipelined mode
+	m_Window = m_GraphicsManager->IsPipelined() ? nullptr : m_GraphicsManager->GetWindow();
 	m_ToolWindow.OnEngineInit();
 	Log::GetInstance()->Msg("Enabling Editor");
 	if(m_Window)
@@ -67,13 +68,21 @@ void Editor::OnEngineInit()
 	}
 	else
 	{
-		Log::GetInstance()->Msg("Could not enable Editor");
+		m_Enable = false;
+		if (m_GraphicsManager->IsPipelined())
+		{
+			Log::GetInstance()->Error("[Warning] The editor is disabled by pipelinedRendering, the render thread owns the OpenGL context");
+		}
+		else
+		{
+			Log::GetInstance()->Msg("Could not enable Editor");
+		}
 	}
 
 }
 void Editor::OnUpdate(float dt)
 {
-	if(m_KeyboardManager->IsKeyDown(enablingKey))
+	if(m_Window && m_KeyboardManager->IsKeyDown(enablingKey))
 	{
 		m_Enable = !m_Enable;
 		m_Config->editor = m_Enable;
@@ -112,12 +121,13 @@ void Editor::OnUpdate(float dt)
 			ImGui::Separator();
 			for (auto i = 0u; i < configPtr->currentEntitiesNmb; i++)
 			{
-				if(m_EntityManager->GetMask(i+1) != INVALID_ENTITY)
+				const auto entity = m_EntityManager->GetEntityByIndex(i);
+				if(m_EntityManager->GetMask(entity) != INVALID_ENTITY)
 				{
-					auto& entityInfo = m_EntityManager->GetEntityInfo(i+1);
-					if(ImGui::Selectable(entityInfo.name.c_str(), selectedEntity-1 == i))
+					auto* entityInfo = m_EntityManager->GetEntityInfo(entity);
+					if(ImGui::Selectable(entityInfo->name.c_str(), selectedEntity == entity))
 					{
-						selectedEntity = i + 1;
+						selectedEntity = entity;
 					}
 				}
 			}
@@ -136,10 +146,21 @@ void Editor::OnUpdate(float dt)
 			ImGui::Separator();
 
 
+			if(!m_EntityManager->IsEntityValid(selectedEntity))
+			{
+				//The selected entity was destroyed, its index can be reused by another one
+				selectedEntity = INVALID_ENTITY;
+			}
 			if(selectedEntity != INVALID_ENTITY)
 			{
-				auto& entityInfo = m_EntityManager->GetEntityInfo(selectedEntity);
-				ImGui::InputText("Name", &entityInfo.name[0u], 15);
+				auto* entityInfo = m_EntityManager->GetEntityInfo(selectedEntity);
+				//Edit a copy of the name so the name index of the entity manager is updated
+				char nameBuffer[64] = {};
+				entityInfo->name.copy(nameBuffer, sizeof(nameBuffer) - 1);
+				if(ImGui::InputText("Name", nameBuffer, sizeof(nameBuffer)))
+				{
+					m_EntityManager->SetEntityName(selectedEntity, nameBuffer);
+				}
 
 				for(auto& drawableComponentManager: m_DrawableObservers)
                 {
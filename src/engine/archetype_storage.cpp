@@ -0,0 +1,335 @@
+/*
+MIT License
+
+Copyright (c) 2017 SAE Institute Switzerland AG
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <algorithm>
+
+#include <engine/archetype_storage.h>
+#include <utility/log.h>
+
+namespace sfge
+{
+
+namespace
+{
+size_t AlignOffset(size_t offset, size_t alignment)
+{
+	return (offset + alignment - 1) / alignment * alignment;
+}
+}
+
+ArchetypeStorage::~ArchetypeStorage()
+{
+	Clear();
+}
+
+bool ArchetypeStorage::IsComponentTypeRegistered(int componentTypeIndex) const
+{
+	return m_ComponentTypes[componentTypeIndex].construct != nullptr;
+}
+
+void* ArchetypeStorage::AddComponent(Entity entity, int componentTypeIndex)
+{
+	if (auto* component = GetComponent(entity, componentTypeIndex))
+	{
+		return component;
+	}
+	const auto& location = GetLocation(entity);
+	if (location.archetype != INVALID_ARCHETYPE && m_Archetypes[location.archetype]->GetEntity(location.row) != entity)
+	{
+		//The row belongs to the entity now using this index, an outdated handle must not move it
+		Log::GetInstance()->Error("[Error] Trying to add a component with an outdated entity");
+		return nullptr;
+	}
+	const EntityMask mask = location.archetype == INVALID_ARCHETYPE ? 0 : m_Archetypes[location.archetype]->mask;
+	MoveEntity(entity, mask | (EntityMask(1) << componentTypeIndex));
+	return GetComponent(entity, componentTypeIndex);
+}
+
+void ArchetypeStorage::RemoveComponent(Entity entity, int componentTypeIndex)
+{
+	if (!HasComponent(entity, componentTypeIndex))
+	{
+		return;
+	}
+	const auto& location = GetLocation(entity);
+	MoveEntity(entity, m_Archetypes[location.archetype]->mask & ~(EntityMask(1) << componentTypeIndex));
+}
+
+void ArchetypeStorage::RemoveEntity(Entity entity)
+{
+	const auto entityIndex = GetEntityIndex(entity);
+	if (entity == INVALID_ENTITY || entityIndex >= m_EntityLocations.size())
+	{
+		return;
+	}
+	const auto& location = m_EntityLocations[entityIndex];
+	if (location.archetype != INVALID_ARCHETYPE && m_Archetypes[location.archetype]->GetEntity(location.row) == entity)
+	{
+		MoveEntity(entity, 0);
+	}
+}
+
+void* ArchetypeStorage::GetComponent(Entity entity, int componentTypeIndex) const
+{
+	if (!HasComponent(entity, componentTypeIndex))
+	{
+		return nullptr;
+	}
+	const auto& location = m_EntityLocations[GetEntityIndex(entity)];
+	return m_Archetypes[location.archetype]->GetComponent(location.row, componentTypeIndex,
+		m_ComponentTypes[componentTypeIndex].size);
+}
+
+bool ArchetypeStorage::HasComponent(Entity entity, int componentTypeIndex) const
+{
+	const auto entityIndex = GetEntityIndex(entity);
+	if (entity == INVALID_ENTITY || entityIndex >= m_EntityLocations.size())
+	{
+		return false;
+	}
+	const auto& location = m_EntityLocations[entityIndex];
+	if (location.archetype == INVALID_ARCHETYPE)
+	{
+		return false;
+	}
+	const auto& archetype = *m_Archetypes[location.archetype];
+	return (archetype.mask & (EntityMask(1) << componentTypeIndex)) != 0 && archetype.GetEntity(location.row) == entity;
+}
+
+size_t ArchetypeStorage::GetComponentNmb(int componentTypeIndex) const
+{
+	size_t componentNmb = 0;
+	for (const auto& archetype : m_Archetypes)
+	{
+		if ((archetype->mask & (EntityMask(1) << componentTypeIndex)) != 0)
+		{
+			componentNmb += archetype->count;
+		}
+	}
+	return componentNmb;
+}
+
+void ArchetypeStorage::ClearComponentType(int componentTypeIndex)
+{
+	//Removing the component moves the entities to archetypes without it, appended after the current ones
+	const auto archetypeNmb = m_Archetypes.size();
+	for (auto archetypeIndex = 0u; archetypeIndex < archetypeNmb; archetypeIndex++)
+	{
+		auto& archetype = *m_Archetypes[archetypeIndex];
+		if ((archetype.mask & (EntityMask(1) << componentTypeIndex)) == 0)
+		{
+			continue;
+		}
+		while (archetype.count > 0)
+		{
+			RemoveComponent(archetype.GetEntity(archetype.count - 1), componentTypeIndex);
+		}
+	}
+}
+
+void ArchetypeStorage::Clear()
+{
+	for (auto& archetype : m_Archetypes)
+	{
+		for (size_t row = 0; row < archetype->count; row++)
+		{
+			for (auto componentTypeIndex : archetype->componentTypeIndexes)
+			{
+				const auto& componentType = m_ComponentTypes[componentTypeIndex];
+				componentType.destroy(archetype->GetComponent(row, componentTypeIndex, componentType.size));
+			}
+		}
+		archetype->count = 0;
+		archetype->chunks.clear();
+	}
+	m_EntityLocations.assign(m_EntityLocations.size(), EntityLocation());
+}
+
+size_t ArchetypeStorage::GetArchetypeNmb() const
+{
+	return m_Archetypes.size();
+}
+
+unsigned char* ArchetypeStorage::Archetype::GetComponent(size_t row, int componentTypeIndex, size_t componentSize) const
+{
+	auto& chunk = *chunks[row / chunkCapacity];
+	return chunk.data + columnOffsets[componentTypeIndex] + (row % chunkCapacity) * componentSize;
+}
+
+Entity& ArchetypeStorage::Archetype::GetEntity(size_t row) const
+{
+	auto& chunk = *chunks[row / chunkCapacity];
+	return reinterpret_cast<Entity*>(chunk.data)[row % chunkCapacity];
+}
+
+unsigned ArchetypeStorage::GetOrCreateArchetype(EntityMask mask)
+{
+	const auto archetypeIt = m_ArchetypeIndexes.find(mask);
+	if (archetypeIt != m_ArchetypeIndexes.end())
+	{
+		return archetypeIt->second;
+	}
+	auto archetype = std::make_unique<Archetype>();
+	archetype->mask = mask;
+	size_t rowSize = sizeof(Entity);
+	for (auto componentTypeIndex = 0u; componentTypeIndex < MAX_ARCHETYPE_COMPONENT_TYPES; componentTypeIndex++)
+	{
+		if ((mask & (EntityMask(1) << componentTypeIndex)) == 0)
+		{
+			continue;
+		}
+		if (!IsComponentTypeRegistered(componentTypeIndex))
+		{
+			Log::GetInstance()->Error("Component type not registered in the archetype storage");
+			continue;
+		}
+		archetype->componentTypeIndexes.push_back(componentTypeIndex);
+		rowSize += m_ComponentTypes[componentTypeIndex].size;
+	}
+	//Each column starts on a cache line, remove rows until the padding fits in the chunk
+	const auto computeLayout = [this, &archetype](size_t capacity)
+	{
+		size_t offset = capacity * sizeof(Entity);
+		for (auto componentTypeIndex : archetype->componentTypeIndexes)
+		{
+			offset = AlignOffset(offset, CACHE_LINE_SIZE);
+			archetype->columnOffsets[componentTypeIndex] = offset;
+			offset += capacity * m_ComponentTypes[componentTypeIndex].size;
+		}
+		return offset;
+	};
+	size_t capacity = ARCHETYPE_CHUNK_SIZE / rowSize;
+	while (capacity > 1 && computeLayout(capacity) > ARCHETYPE_CHUNK_SIZE)
+	{
+		capacity--;
+	}
+	if (capacity == 0 || computeLayout(capacity) > ARCHETYPE_CHUNK_SIZE)
+	{
+		Log::GetInstance()->Error("Archetype components are bigger than a chunk");
+	}
+	archetype->chunkCapacity = std::max<size_t>(capacity, 1);
+
+	const auto archetypeIndex = static_cast<unsigned>(m_Archetypes.size());
+	m_Archetypes.push_back(std::move(archetype));
+	m_ArchetypeIndexes[mask] = archetypeIndex;
+	return archetypeIndex;
+}
+
+size_t ArchetypeStorage::AllocateRow(Archetype& archetype, Entity entity)
+{
+	if (archetype.count == archetype.chunks.size() * archetype.chunkCapacity)
+	{
+		archetype.chunks.push_back(std::make_unique<Chunk>());
+	}
+	const auto row = archetype.count++;
+	archetype.GetEntity(row) = entity;
+	return row;
+}
+
+void ArchetypeStorage::FreeRow(Archetype& archetype, size_t row)
+{
+	const auto lastRow = archetype.count - 1;
+	for (auto componentTypeIndex : archetype.componentTypeIndexes)
+	{
+		const auto& componentType = m_ComponentTypes[componentTypeIndex];
+		auto* component = archetype.GetComponent(row, componentTypeIndex, componentType.size);
+		componentType.destroy(component);
+		if (row != lastRow)
+		{
+			auto* lastComponent = archetype.GetComponent(lastRow, componentTypeIndex, componentType.size);
+			componentType.moveConstruct(component, lastComponent);
+			componentType.destroy(lastComponent);
+		}
+	}
+	if (row != lastRow)
+	{
+		const auto movedEntity = archetype.GetEntity(lastRow);
+		archetype.GetEntity(row) = movedEntity;
+		m_EntityLocations[GetEntityIndex(movedEntity)].row = row;
+	}
+	archetype.count--;
+	//Keep at most one empty chunk to avoid reallocating when an entity goes back and forth
+	while (archetype.chunks.size() > 1 && (archetype.chunks.size() - 1) * archetype.chunkCapacity > archetype.count)
+	{
+		archetype.chunks.pop_back();
+	}
+}
+
+void ArchetypeStorage::MoveEntity(Entity entity, EntityMask newMask)
+{
+	const auto oldLocation = GetLocation(entity);
+	Archetype* oldArchetype = oldLocation.archetype == INVALID_ARCHETYPE ?
+		nullptr : m_Archetypes[oldLocation.archetype].get();
+	EntityLocation newLocation;
+	if (newMask != 0)
+	{
+		newLocation.archetype = GetOrCreateArchetype(newMask);
+		auto& newArchetype = *m_Archetypes[newLocation.archetype];
+		newLocation.row = AllocateRow(newArchetype, entity);
+		for (auto componentTypeIndex : newArchetype.componentTypeIndexes)
+		{
+			const auto& componentType = m_ComponentTypes[componentTypeIndex];
+			auto* component = newArchetype.GetComponent(newLocation.row, componentTypeIndex, componentType.size);
+			if (oldArchetype != nullptr && (oldArchetype->mask & (EntityMask(1) << componentTypeIndex)) != 0)
+			{
+				componentType.moveConstruct(component,
+					oldArchetype->GetComponent(oldLocation.row, componentTypeIndex, componentType.size));
+			}
+			else
+			{
+				componentType.construct(component);
+			}
+		}
+	}
+	if (oldArchetype != nullptr)
+	{
+		FreeRow(*oldArchetype, oldLocation.row);
+	}
+	m_EntityLocations[GetEntityIndex(entity)] = newLocation;
+}
+
+ArchetypeStorage::EntityLocation& ArchetypeStorage::GetLocation(Entity entity)
+{
+	const auto entityIndex = GetEntityIndex(entity);
+	if (entityIndex >= m_EntityLocations.size())
+	{
+		m_EntityLocations.resize(entityIndex + 1);
+	}
+	return m_EntityLocations[entityIndex];
+}
+
+ArchetypeChunkView ArchetypeStorage::GetChunkView(const Archetype& archetype, size_t chunkIndex) const
+{
+	ArchetypeChunkView chunkView;
+	const auto firstRow = chunkIndex * archetype.chunkCapacity;
+	chunkView.entities = &archetype.GetEntity(firstRow);
+	chunkView.count = std::min(archetype.chunkCapacity, archetype.count - firstRow);
+	for (auto componentTypeIndex : archetype.componentTypeIndexes)
+	{
+		chunkView.columns[componentTypeIndex] = archetype.chunks[chunkIndex]->data + archetype.columnOffsets[componentTypeIndex];
+	}
+	return chunkView;
+}
+
+}
@@ -70,6 +70,24 @@ std::unique_ptr<Configuration> Configuration::LoadConfig(json& configJson)
 
 	if(CheckJsonExists(configJson, "devMode"))
 		newConfig->devMode = configJson["devMode"];
+	if(CheckJsonExists(configJson, "windowLess"))
+		newConfig->windowLess = configJson["windowLess"];
+	if(CheckJsonNumber(configJson, "fixedDeltaTime"))
+		newConfig->fixedDeltaTime = configJson["fixedDeltaTime"];
+	if(CheckJsonNumber(configJson, "headlessTickNmb"))
+		newConfig->headlessTickNmb = configJson["headlessTickNmb"];
+	if(CheckJsonNumber(configJson, "maxFixedUpdatesPerFrame"))
+		newConfig->maxFixedUpdatesPerFrame = configJson["maxFixedUpdatesPerFrame"];
+	if(CheckJsonExists(configJson, "interpolateTransforms"))
+		newConfig->interpolateTransforms = configJson["interpolateTransforms"];
+	if(CheckJsonExists(configJson, "pipelinedRendering"))
+		newConfig->pipelinedRendering = configJson["pipelinedRendering"];
+	if(CheckJsonExists(configJson, "archetypeStorage"))
+		newConfig->archetypeStorage = configJson["archetypeStorage"];
+	if(CheckJsonExists(configJson, "transformSoA"))
+		newConfig->transformSoA = configJson["transformSoA"];
+	if(CheckJsonNumber(configJson, "frameAllocatorSize"))
+		newConfig->frameAllocatorSize = configJson["frameAllocatorSize"];
 	return newConfig;
 }
 
@@ -23,6 +23,7 @@ SOFTWARE.
 */
 
 #include <memory>
+#include <algorithm>
 
 #include <SFML/System/Time.hpp>
 #include <SFML/System/Clock.hpp>
@@ -43,6 +44,9 @@ SOFTWARE.
 #include <editor/editor.h>
 #include <engine/entity.h>
 #include <engine/transform2d.h>
+#include <engine/component.h>
+#include <engine/snapshot.h>
+#include <engine/memory.h>
 
 
 namespace sfge
@@ -88,6 +92,7 @@ Engine::Engine()
 Engine::~Engine()
 {
 	m_SystemsContainer = nullptr;
+	ResetFrameAllocators();
 }
 
 void Engine::Init(std::string configFilename)
@@ -126,7 +131,18 @@ void Engine::InitModules()
         oss << "Number of cores on machine: "<<std::thread::hardware_concurrency ();
         Log::GetInstance ()->Msg (oss.str ());
     }
-    m_ThreadPool.resize(std::thread::hardware_concurrency ()-1);
+    m_JobSystem.Init(std::max(std::thread::hardware_concurrency (), 1u) - 1);
+	ResetFrameAllocators();
+	m_FrameResources.clear();
+	m_FrameAllocators.clear();
+	m_FrameMemory.clear();
+	for (size_t workerIndex = 0; workerIndex < m_JobSystem.GetWorkerNmb(); workerIndex++)
+	{
+		m_FrameMemory.emplace_back(new char[m_Config->frameAllocatorSize]);
+		m_FrameAllocators.emplace_back(
+			std::make_unique<LinearAllocator>(m_Config->frameAllocatorSize, m_FrameMemory.back().get()));
+		m_FrameResources.emplace_back(std::make_unique<AllocatorResource>(*m_FrameAllocators.back()));
+	}
 
 	m_SystemsContainer->entityManager.OnEngineInit();
 	m_SystemsContainer->transformManager.OnEngineInit();
@@ -139,18 +155,105 @@ void Engine::InitModules()
 	m_SystemsContainer->editor.OnEngineInit();
 
 	m_Window = m_SystemsContainer->graphics2dManager.GetWindow();
+	InitUpdateGraph();
 	running = true;
 }
 
+/**
+ * \brief Union of the component types declared by the python systems, the null slots are skipped
+ */
+static void GetPySystemsAccess(const std::vector<PySystem*>& pySystems, EntityMask& readMask, EntityMask& writeMask)
+{
+	readMask = 0;
+	writeMask = 0;
+	for (auto* pySystem : pySystems)
+	{
+		if (pySystem == nullptr)
+		{
+			continue;
+		}
+		EntityMask systemReadMask = 0;
+		EntityMask systemWriteMask = 0;
+		pySystem->GetComponentAccess(systemReadMask, systemWriteMask);
+		readMask |= systemReadMask;
+		writeMask |= systemWriteMask;
+	}
+}
+
+void Engine::InitUpdateGraph()
+{
+	const auto transformMask = static_cast<EntityMask>(ComponentType::TRANSFORM2D);
+	const auto spriteMask = static_cast<EntityMask>(ComponentType::SPRITE2D);
+	const auto shapeMask = static_cast<EntityMask>(ComponentType::SHAPE2D);
+	const auto bodyMask = static_cast<EntityMask>(ComponentType::BODY2D);
+	const auto colliderMask = static_cast<EntityMask>(ComponentType::COLLIDER2D);
+	const auto soundMask = static_cast<EntityMask>(ComponentType::SOUND);
+	auto& systems = *m_SystemsContainer;
+
+	EntityMask pythonReadMask, pythonWriteMask;
+	GetPySystemsAccess(systems.pythonEngine.GetPySystemManager().GetPySystems(), pythonReadMask, pythonWriteMask);
+	EntityMask sceneReadMask, sceneWriteMask;
+	GetPySystemsAccess(systems.sceneManager.GetSceneSystems(), sceneReadMask, sceneWriteMask);
+
+	//With all the components, the python systems run alone and can create or destroy entities
+	const bool pythonLocked = pythonReadMask != ALL_COMPONENTS_MASK || pythonWriteMask != ALL_COMPONENTS_MASK;
+	const bool sceneLocked = sceneReadMask != ALL_COMPONENTS_MASK || sceneWriteMask != ALL_COMPONENTS_MASK;
+
+	m_UpdateGraph.Clear();
+	m_UpdateGraph.AddTask("PythonUpdate", [this, &systems, pythonLocked]
+	{
+		systems.entityManager.SetStructuralChangesLocked(pythonLocked);
+		systems.pythonEngine.OnUpdate(m_DeltaTime);
+		systems.entityManager.SetStructuralChangesLocked(false);
+	}, pythonReadMask, pythonWriteMask, true);
+	m_UpdateGraph.AddTask("SceneUpdate", [this, &systems, sceneLocked]
+	{
+		systems.entityManager.SetStructuralChangesLocked(sceneLocked);
+		systems.sceneManager.OnUpdate(m_DeltaTime);
+		systems.entityManager.SetStructuralChangesLocked(false);
+	}, sceneReadMask, sceneWriteMask, true);
+	m_UpdateGraph.AddTask("Transform2dUpdate", [this, &systems]{ systems.transformManager.OnUpdate(m_DeltaTime); },
+		0, transformMask);
+	m_UpdateGraph.AddTask("Graphics2dUpdate", [this, &systems]{ systems.graphics2dManager.OnUpdate(m_DeltaTime); },
+		0, 0, true);
+	m_UpdateGraph.AddTask("SpriteUpdate", [this, &systems]{ systems.graphics2dManager.GetSpriteManager()->OnUpdate(m_DeltaTime); },
+		transformMask, spriteMask);
+	m_UpdateGraph.AddTask("ShapeUpdate", [this, &systems]{ systems.graphics2dManager.GetShapeManager()->OnUpdate(m_DeltaTime); },
+		transformMask, shapeMask);
+	m_UpdateGraph.AddTask("AudioUpdate", [this, &systems]{ systems.audioManager.OnUpdate(m_DeltaTime); },
+		0, soundMask);
+	//The editor can edit any component, added last it only waits for the other tasks instead of serializing them
+	m_UpdateGraph.AddTask("EditorUpdate", [this, &systems]{ systems.editor.OnUpdate(m_DeltaTime); },
+		ALL_COMPONENTS_MASK, ALL_COMPONENTS_MASK, true);
+	m_UpdateGraph.Build();
+
+	m_FixedUpdateGraph.Clear();
+	m_FixedUpdateGraph.AddTask("StorePreviousTransforms", [&systems]{ systems.transformManager.StorePreviousTransforms(); },
+		transformMask, 0);
+	//The contact callbacks call the python systems, the physics step touches their component types too
+	m_FixedUpdateGraph.AddTask("PhysicsFixedUpdate", [&systems]{ systems.physicsManager.OnFixedUpdate(); },
+		colliderMask | bodyMask | transformMask | pythonReadMask | sceneReadMask,
+		bodyMask | transformMask | pythonWriteMask | sceneWriteMask, true);
+	m_FixedUpdateGraph.AddTask("PythonFixedUpdate", [&systems]{ systems.pythonEngine.OnFixedUpdate(); },
+		pythonReadMask, pythonWriteMask, true);
+	m_FixedUpdateGraph.AddTask("SceneFixedUpdate", [&systems]{ systems.sceneManager.OnFixedUpdate(); },
+		sceneReadMask, sceneWriteMask, true);
+	m_FixedUpdateGraph.Build();
+	m_UpdateGraphDirty = false;
+}
+
 void Engine::Start()
 {
-	sf::Clock globalClock;
+	if (m_Config != nullptr && m_Config->windowLess)
+	{
+		StartHeadless();
+		return;
+	}
 	sf::Clock updateClock;
 	sf::Clock fixedUpdateClock;
 	sf::Clock graphicsUpdateClock;
-	sf::Time previousFixedUpdateTime = globalClock.getElapsedTime();
-	sf::Time deltaFixedUpdateTime = sf::Time();
 	sf::Time dt = sf::Time();
+	m_FixedUpdateAccumulator = 0.0f;
 
 	rmt_BindOpenGL();
 	while (running && m_Window != nullptr)
@@ -158,8 +261,8 @@ void Engine::Start()
 
 		rmt_ScopedOpenGLSample(SFGE_Frame_GL);
 		rmt_ScopedCPUSample(SFGE_Frame,0)
+		ResetFrameAllocators();
 
-		bool isFixedUpdateFrame = false;
 		sf::Event event{};
 		while (m_Window != nullptr && 
 			m_Window->pollEvent(event))
@@ -168,7 +271,7 @@ void Engine::Start()
 			if (event.type == sf::Event::Closed)
 			{
 				running = false;
-				m_Window->close();
+				m_SystemsContainer->graphics2dManager.CloseWindow();
 			}
 
 			if(event.type == sf::Event::Resized)
@@ -185,37 +288,38 @@ void Engine::Start()
 
 
 		m_SystemsContainer->inputManager.OnUpdate(dt.asSeconds());
-		auto fixedUpdateTime = globalClock.getElapsedTime() - previousFixedUpdateTime;
-		if (fixedUpdateTime.asSeconds() > m_Config->fixedDeltaTime)
+
+		fixedUpdateClock.restart();
+		const bool isFixedUpdateFrame = RunFixedUpdates(dt.asSeconds()) > 0u;
+		if (isFixedUpdateFrame)
 		{
-			fixedUpdateClock.restart ();
-			m_SystemsContainer->physicsManager.OnFixedUpdate();
-			previousFixedUpdateTime = globalClock.getElapsedTime();
-			m_SystemsContainer->pythonEngine.OnFixedUpdate();
-			m_SystemsContainer->sceneManager.OnFixedUpdate();
-			deltaFixedUpdateTime = fixedUpdateClock.getElapsedTime ();
-			m_FrameData.frameFixedUpdate = deltaFixedUpdateTime;
-			isFixedUpdateFrame = true;
+			m_FrameData.frameFixedUpdate = fixedUpdateClock.getElapsedTime();
 		}
-		m_SystemsContainer->pythonEngine.OnUpdate(dt.asSeconds());
-
-		m_SystemsContainer->sceneManager.OnUpdate(dt.asSeconds());
-
-		m_SystemsContainer->editor.OnUpdate(dt.asSeconds());
-        m_SystemsContainer->transformManager.OnUpdate(dt.asSeconds());
-		m_SystemsContainer->graphics2dManager.OnUpdate(dt.asSeconds());
-
-
+		if (m_UpdateGraphDirty)
+		{
+			InitUpdateGraph();
+		}
+		m_UpdateGraph.Execute(m_JobSystem);
+		//Sync point, no system runs until the next frame
+		m_SystemsContainer->entityManager.FlushCommandBuffers();
 
 		graphicsUpdateClock.restart();
 
-		m_SystemsContainer->graphics2dManager.OnDraw();
+		if (m_SystemsContainer->graphics2dManager.IsPipelined())
+		{
+			//Only waits when the render thread is still drawing the previous frame
+			m_SystemsContainer->graphics2dManager.PublishSnapshot();
+		}
+		else
+		{
+			m_SystemsContainer->graphics2dManager.OnDraw();
 
-		m_SystemsContainer->pythonEngine.OnDraw();
-		m_SystemsContainer->sceneManager.OnDraw();
-		m_SystemsContainer->editor.OnDraw();
+			m_SystemsContainer->pythonEngine.OnDraw();
+			m_SystemsContainer->sceneManager.OnDraw();
+			m_SystemsContainer->editor.OnDraw();
 
-        m_SystemsContainer->graphics2dManager.Display();
+			m_SystemsContainer->graphics2dManager.Display();
+		}
 		const sf::Time graphicsDt = graphicsUpdateClock.getElapsedTime ();
 		dt = updateClock.restart();
 		if(isFixedUpdateFrame)
@@ -230,9 +334,66 @@ void Engine::Start()
 	Destroy();
 }
 
-void Engine::Destroy() 
+void Engine::StartHeadless()
+{
+	const unsigned int tickNmb = m_Config->headlessTickNmb;
+	for (unsigned int tick = 0u; running && (tickNmb == 0u || tick < tickNmb); tick++)
+	{
+		HeadlessTick();
+	}
+	running = false;
+	Destroy();
+}
+
+void Engine::HeadlessTick()
+{
+	rmt_ScopedCPUSample(SFGE_HeadlessFrame, 0)
+	ResetFrameAllocators();
+	const float fixedDeltaTime = m_Config->fixedDeltaTime;
+
+	sf::Clock tickClock;
+	FixedUpdate();
+	m_FrameData.frameFixedUpdate = tickClock.getElapsedTime();
+
+	m_SystemsContainer->pythonEngine.OnUpdate(fixedDeltaTime);
+	m_SystemsContainer->sceneManager.OnUpdate(fixedDeltaTime);
+	m_SystemsContainer->transformManager.OnUpdate(fixedDeltaTime);
+	m_SystemsContainer->entityManager.FlushCommandBuffers();
+
+	m_FrameData.frameTotalTime = tickClock.getElapsedTime();
+	m_DeltaTime = fixedDeltaTime;
+}
+
+unsigned int Engine::RunFixedUpdates(float dt)
+{
+	const float fixedDeltaTime = m_Config->fixedDeltaTime;
+	const unsigned int maxFixedUpdates = std::max(m_Config->maxFixedUpdatesPerFrame, 1u);
+	m_FixedUpdateAccumulator += dt;
+	//Drop the time we could not catch up anyway, avoiding the spiral of death
+	m_FixedUpdateAccumulator = std::min(m_FixedUpdateAccumulator, fixedDeltaTime * maxFixedUpdates);
+	unsigned int fixedUpdateNmb = 0u;
+	for (; m_FixedUpdateAccumulator >= fixedDeltaTime && fixedUpdateNmb < maxFixedUpdates; fixedUpdateNmb++)
+	{
+		FixedUpdate();
+		m_FixedUpdateAccumulator -= fixedDeltaTime;
+	}
+	m_FixedUpdateAlpha = m_FixedUpdateAccumulator / fixedDeltaTime;
+	return fixedUpdateNmb;
+}
+
+void Engine::FixedUpdate()
 {
+	if (m_UpdateGraphDirty)
+	{
+		InitUpdateGraph();
+	}
+	m_FixedUpdateGraph.Execute(m_JobSystem);
+	m_SystemsContainer->entityManager.FlushCommandBuffers();
+}
 
+void Engine::Destroy() 
+{
+	m_JobSystem.Destroy();
 	m_SystemsContainer->pythonEngine.Destroy();
 	m_SystemsContainer->entityManager.Destroy();
 	m_SystemsContainer->graphics2dManager.Destroy();
@@ -248,6 +409,7 @@ void Engine::Destroy()
 void Engine::Clear() 
 {
 	m_SystemsContainer->entityManager.OnBeforeSceneLoad();
+	m_SystemsContainer->transformManager.OnBeforeSceneLoad();
 	m_SystemsContainer->graphics2dManager.OnBeforeSceneLoad();
 	m_SystemsContainer->audioManager.OnBeforeSceneLoad();
 	m_SystemsContainer->sceneManager.OnBeforeSceneLoad();
@@ -268,8 +430,30 @@ void Engine::Collect()
 	m_SystemsContainer->pythonEngine.OnAfterSceneLoad();
 	m_SystemsContainer->editor.OnAfterSceneLoad();
 	m_SystemsContainer->physicsManager.OnAfterSceneLoad();
+	m_UpdateGraphDirty = true;
+}
+
+void Engine::SaveSnapshot(Snapshot& snapshot)
+{
+	snapshot.Clear();
+	m_SystemsContainer->entityManager.SaveSnapshot(snapshot);
+	m_SystemsContainer->transformManager.SaveSnapshot(snapshot);
+	m_SystemsContainer->physicsManager.GetBodyManager()->SaveSnapshot(snapshot);
+	m_SystemsContainer->pythonEngine.GetPySystemManager().SaveSnapshot(snapshot);
 }
 
+bool Engine::RestoreSnapshot(Snapshot& snapshot)
+{
+	snapshot.Rewind();
+	if (!m_SystemsContainer->entityManager.RestoreSnapshot(snapshot))
+	{
+		return false;
+	}
+	m_SystemsContainer->transformManager.RestoreSnapshot(snapshot);
+	m_SystemsContainer->physicsManager.GetBodyManager()->RestoreSnapshot(snapshot);
+	m_SystemsContainer->pythonEngine.GetPySystemManager().RestoreSnapshot(snapshot);
+	return true;
+}
 
 Configuration * Engine::GetConfig() const
 {
@@ -322,9 +506,29 @@ Editor* Engine::GetEditor()
 	return m_SystemsContainer ? &m_SystemsContainer->editor : nullptr;
 }
 
-ctpl::thread_pool & Engine::GetThreadPool()
+JobSystem& Engine::GetJobSystem()
+{
+	return m_JobSystem;
+}
+
+LinearAllocator& Engine::GetFrameAllocator()
+{
+	const auto workerIndex = m_JobSystem.GetCurrentWorkerIndex();
+	return *m_FrameAllocators[workerIndex < m_FrameAllocators.size() ? workerIndex : 0];
+}
+
+AllocatorResource& Engine::GetFrameResource()
 {
-	return m_ThreadPool;
+	const auto workerIndex = m_JobSystem.GetCurrentWorkerIndex();
+	return *m_FrameResources[workerIndex < m_FrameResources.size() ? workerIndex : 0];
+}
+
+void Engine::ResetFrameAllocators()
+{
+	for (auto& frameAllocator : m_FrameAllocators)
+	{
+		frameAllocator->clear();
+	}
 }
 
 ProfilerFrameData& Engine::GetProfilerFrameData()
@@ -341,4 +545,9 @@ float Engine::GetDeltaTime()
 {
 	return m_DeltaTime;
 }
+
+float Engine::GetFixedUpdateAlpha() const
+{
+	return m_FixedUpdateAlpha;
+}
 }
@@ -22,109 +22,665 @@ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
 SOFTWARE.
 */
 
+#include <algorithm>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#endif
+
 #include <engine/engine.h>
 #include <engine/config.h>
 #include <engine/entity.h>
+#include <engine/archetype_storage.h>
+#include <engine/component.h>
+#include <engine/scene.h>
+#include <engine/snapshot.h>
 #include <engine/globals.h>
 #include <python/python_engine.h>
+#include <utility/log.h>
 
 namespace sfge
 {
+
+namespace
+{
+/**
+ * \brief Call function with the index of every mask m where (m & (required | excluded)) == required
+ */
+template<typename F>
+void ScanMasks(const EntityMask* masks, size_t maskNmb, EntityMask requiredMask, EntityMask excludedMask, const F& function)
+{
+	const EntityMask testedMask = requiredMask | excludedMask;
+	size_t i = 0;
+#if defined(__AVX2__)
+	const __m256i tested = _mm256_set1_epi64x(static_cast<long long>(testedMask));
+	const __m256i required = _mm256_set1_epi64x(static_cast<long long>(requiredMask));
+	for (; i + 4 <= maskNmb; i += 4)
+	{
+		const __m256i values = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(masks + i));
+		const __m256i matches = _mm256_cmpeq_epi64(_mm256_and_si256(values, tested), required);
+		const auto matchBits = _mm256_movemask_pd(_mm256_castsi256_pd(matches));
+		if (matchBits == 0)
+		{
+			continue;
+		}
+		for (size_t lane = 0; lane < 4; lane++)
+		{
+			if ((matchBits & (1 << lane)) != 0)
+			{
+				function(i + lane);
+			}
+		}
+	}
+#elif defined(__SSE2__) || defined(_M_X64)
+	//SSE2 has no 64-bit compare, a lane matches when both of its 32-bit halves are equal
+	const __m128i tested = _mm_set1_epi64x(static_cast<long long>(testedMask));
+	const __m128i required = _mm_set1_epi64x(static_cast<long long>(requiredMask));
+	for (; i + 2 <= maskNmb; i += 2)
+	{
+		const __m128i values = _mm_loadu_si128(reinterpret_cast<const __m128i*>(masks + i));
+		const __m128i matches = _mm_cmpeq_epi32(_mm_and_si128(values, tested), required);
+		const auto matchBytes = _mm_movemask_epi8(matches);
+		if ((matchBytes & 0x00FF) == 0x00FF)
+		{
+			function(i);
+		}
+		if ((matchBytes & 0xFF00) == 0xFF00)
+		{
+			function(i + 1);
+		}
+	}
+#endif
+	for (; i < maskNmb; i++)
+	{
+		if ((masks[i] & testedMask) == requiredMask)
+		{
+			function(i);
+		}
+	}
+}
+}
 void editor::EntityInfo::DrawOnInspector()
 {
 
 }
 
+EntityQuery::EntityQuery(EntityMask mask) : m_Mask(mask)
+{
+}
+
+EntityMask EntityQuery::GetMask() const
+{
+	return m_Mask;
+}
+
+bool EntityQuery::Matches(EntityMask entityMask) const
+{
+	return entityMask != 0 && (entityMask & m_Mask) == m_Mask;
+}
+
+const std::vector<Entity>& EntityQuery::GetEntities() const
+{
+	return m_Entities;
+}
+
+size_t EntityQuery::Size() const
+{
+	return m_Entities.size();
+}
+
+void EntityQuery::Add(Entity entity)
+{
+	const auto entityIndex = GetEntityIndex(entity);
+	if(entityIndex >= m_Positions.size())
+	{
+		m_Positions.resize(entityIndex + 1);
+	}
+	m_Positions[entityIndex] = static_cast<unsigned>(m_Entities.size());
+	m_Entities.push_back(entity);
+}
+
+void EntityQuery::Remove(Entity entity)
+{
+	const auto position = m_Positions[GetEntityIndex(entity)];
+	const auto lastEntity = m_Entities.back();
+	m_Entities[position] = lastEntity;
+	m_Positions[GetEntityIndex(lastEntity)] = position;
+	m_Entities.pop_back();
+}
+
+void EntityQuery::Clear()
+{
+	m_Entities.clear();
+}
+
+void EntityCommandBuffer::CreateEntity(EntityMask mask)
+{
+	m_Commands.push_back({ EntityCommandType::CREATE, INVALID_ENTITY, mask });
+}
+
+void EntityCommandBuffer::DestroyEntity(Entity entity)
+{
+	m_Commands.push_back({ EntityCommandType::DESTROY, entity, 0 });
+}
+
+void EntityCommandBuffer::AddComponentType(Entity entity, ComponentType componentType)
+{
+	m_Commands.push_back({ EntityCommandType::ADD_COMPONENT_TYPE, entity, static_cast<EntityMask>(componentType) });
+}
+
+void EntityCommandBuffer::RemoveComponentType(Entity entity, ComponentType componentType)
+{
+	m_Commands.push_back({ EntityCommandType::REMOVE_COMPONENT_TYPE, entity, static_cast<EntityMask>(componentType) });
+}
+
+bool EntityCommandBuffer::IsEmpty() const
+{
+	return m_Commands.empty();
+}
+
+const std::vector<EntityCommand>& EntityCommandBuffer::GetCommands() const
+{
+	return m_Commands;
+}
+
+const std::vector<Entity>& EntityCommandBuffer::GetCreatedEntities() const
+{
+	return m_CreatedEntities;
+}
+
+EntityManager::EntityManager(Engine& engine) : System(engine)
+{
+	m_CommandBuffers.push_back(std::make_unique<EntityCommandBuffer>());
+}
+
+EntityManager::~EntityManager() = default;
+
 void EntityManager::OnEngineInit()
 {
+	if (m_Engine.GetConfig()->archetypeStorage && m_ArchetypeStorage == nullptr)
+	{
+		m_ArchetypeStorage = std::make_unique<ArchetypeStorage>();
+	}
+	const auto workerNmb = std::max(m_Engine.GetJobSystem().GetWorkerNmb(), size_t(1));
+	while (m_CommandBuffers.size() < workerNmb)
+	{
+		m_CommandBuffers.push_back(std::make_unique<EntityCommandBuffer>());
+	}
 	OnBeforeSceneLoad();
 }
 
 void EntityManager::OnBeforeSceneLoad()
 {
 	m_MaskArray = std::vector<EntityMask>(INIT_ENTITY_NMB, INVALID_ENTITY);
+	m_EntityVersions.assign(INIT_ENTITY_NMB, 0U);
+	m_EntityAlive.assign(INIT_ENTITY_NMB, false);
+	m_FreeEntityIndexes.clear();
+	AddFreeEntityIndexes(0, INIT_ENTITY_NMB);
+	for (auto& entityInfo : m_EntityInfos)
+	{
+		entityInfo.name.clear();
+	}
+	m_EntityNameIndex.clear();
+	for (auto& query : m_Queries)
+	{
+		query->Clear();
+	}
+	if (m_ArchetypeStorage != nullptr)
+	{
+		m_ArchetypeStorage->Clear();
+	}
+	for (auto& commandBuffer : m_CommandBuffers)
+	{
+		commandBuffer->m_Commands.clear();
+		commandBuffer->m_CreatedEntities.clear();
+	}
 }
 
 EntityMask EntityManager::GetMask(Entity entity)
 {
-	return m_MaskArray[entity-1];
+	if(!IsEntityValid(entity))
+	{
+		return 0;
+	}
+	return m_MaskArray[GetEntityIndex(entity)];
 }
 
 Entity EntityManager::CreateEntity(Entity wantedEntity)
 {
-
-    if(wantedEntity == INVALID_ENTITY)
-    {
-        for (Entity entity = 1U; entity <= m_MaskArray.size(); entity++)
-        {
-            if(m_MaskArray[entity-1] == INVALID_ENTITY)
-            {
-                return entity;
-            }
-        }
-    }
-    else
-    {
-        if(m_MaskArray[wantedEntity-1] == INVALID_ENTITY)
-        {
+	if(wantedEntity == INVALID_ENTITY)
+	{
+		while(!m_FreeEntityIndexes.empty())
+		{
+			//Indexes taken by a wanted entity stay in the free list and are skipped here
+			const auto entityIndex = m_FreeEntityIndexes.back();
+			m_FreeEntityIndexes.pop_back();
+			if(!m_EntityAlive[entityIndex])
+			{
+				m_EntityAlive[entityIndex] = true;
+				return MakeEntity(entityIndex, m_EntityVersions[entityIndex]);
+			}
+		}
+	}
+	else
+	{
+		const auto entityIndex = GetEntityIndex(wantedEntity);
+		if(entityIndex < m_MaskArray.size() && !m_EntityAlive[entityIndex])
+		{
+			m_EntityAlive[entityIndex] = true;
+			const auto entity = MakeEntity(entityIndex, m_EntityVersions[entityIndex]);
 			{
 				std::ostringstream oss;
-				oss << "Entity: " << wantedEntity;
-				m_EntityInfos[wantedEntity - 1].name = oss.str();
+				oss << "Entity: " << entityIndex + 1;
+				SetEntityName(entity, oss.str());
 			}
-        	return wantedEntity;
-        }
-    }
+			return entity;
+		}
+	}
 	return INVALID_ENTITY;
 }
 
+std::vector<Entity> EntityManager::CreateEntities(size_t count)
+{
+	std::vector<Entity> entities;
+	entities.reserve(count);
+	while(entities.size() < count && !m_FreeEntityIndexes.empty())
+	{
+		const auto entityIndex = m_FreeEntityIndexes.back();
+		m_FreeEntityIndexes.pop_back();
+		if(!m_EntityAlive[entityIndex])
+		{
+			m_EntityAlive[entityIndex] = true;
+			entities.push_back(MakeEntity(entityIndex, m_EntityVersions[entityIndex]));
+		}
+	}
+	if(entities.size() < count)
+	{
+		std::ostringstream oss;
+		oss << "[Error] Only " << entities.size() << " free entities left out of " << count;
+		Log::GetInstance()->Error(oss.str());
+	}
+	return entities;
+}
+
 void EntityManager::DestroyEntity(Entity entity)
 {
-    for(auto& destroyObserver : m_DestroyObservers)
+	if(!IsEntityValid(entity))
+	{
+		std::ostringstream oss;
+		oss << "[Error] Trying to destroy invalid entity: " << entity;
+		Log::GetInstance()->Error(oss.str());
+		return;
+	}
+	for(auto& destroyObserver : m_DestroyObservers)
+	{
+		destroyObserver->OnDestroy(entity);
+	}
+	ReleaseEntity(entity);
+}
+
+void EntityManager::DestroyEntities(const std::vector<Entity>& entities)
+{
+	std::vector<Entity> validEntities;
+	validEntities.reserve(entities.size());
+	for(auto entity : entities)
+	{
+		if(!IsEntityValid(entity))
+		{
+			std::ostringstream oss;
+			oss << "[Error] Trying to destroy invalid entity: " << entity;
+			Log::GetInstance()->Error(oss.str());
+			continue;
+		}
+		validEntities.push_back(entity);
+	}
+	if(validEntities.empty())
+	{
+		return;
+	}
+	for(auto& destroyObserver : m_DestroyObservers)
+	{
+		destroyObserver->OnDestroyEntities(validEntities);
+	}
+	for(auto entity : validEntities)
+	{
+		ReleaseEntity(entity);
+	}
+}
+
+EntityCommandBuffer& EntityManager::GetCommandBuffer()
+{
+	const auto workerIndex = m_Engine.GetJobSystem().GetCurrentWorkerIndex();
+	return *m_CommandBuffers[workerIndex < m_CommandBuffers.size() ? workerIndex : 0];
+}
+
+void EntityManager::FlushCommandBuffers()
+{
+	m_FlushedCommands.clear();
+	for(auto& commandBuffer : m_CommandBuffers)
+	{
+		commandBuffer->m_CreatedEntities.clear();
+		for(auto& command : commandBuffer->m_Commands)
+		{
+			if(command.type != EntityCommandType::CREATE)
+			{
+				m_FlushedCommands.push_back(command);
+				continue;
+			}
+			//Created first so each buffer gets its entities back in its recording order
+			const auto entity = CreateEntity(INVALID_ENTITY);
+			if(entity == INVALID_ENTITY)
+			{
+				Log::GetInstance()->Error("[Error] No free entity left for the command buffer");
+				continue;
+			}
+			//Lowest bits first, so the transform exists before the components that use it
+			for(size_t bit = 0; bit < sizeof(EntityMask) * 8; bit++)
+			{
+				if((command.mask & (EntityMask(1) << bit)) != 0)
+				{
+					AddComponentFromCommand(entity, static_cast<ComponentType>(EntityMask(1) << bit));
+				}
+			}
+			commandBuffer->m_CreatedEntities.push_back(entity);
+		}
+		commandBuffer->m_Commands.clear();
+	}
+	//Grouping the commands by type and entity index walks the masks and storages linearly
+	std::stable_sort(m_FlushedCommands.begin(), m_FlushedCommands.end(), [](const EntityCommand& command1, const EntityCommand& command2)
+	{
+		if(command1.type != command2.type)
+		{
+			return command1.type < command2.type;
+		}
+		return GetEntityIndex(command1.entity) < GetEntityIndex(command2.entity);
+	});
+	m_DestroyedEntities.clear();
+	for(auto& command : m_FlushedCommands)
+	{
+		switch(command.type)
+		{
+		case EntityCommandType::ADD_COMPONENT_TYPE:
+			//Several threads can add the same component
+			if(IsEntityValid(command.entity) && !HasComponent(command.entity, static_cast<ComponentType>(command.mask)))
+			{
+				AddComponentFromCommand(command.entity, static_cast<ComponentType>(command.mask));
+			}
+			break;
+		case EntityCommandType::REMOVE_COMPONENT_TYPE:
+			if(HasComponent(command.entity, static_cast<ComponentType>(command.mask)))
+			{
+				RemoveComponentFromCommand(command.entity, static_cast<ComponentType>(command.mask));
+			}
+			break;
+		case EntityCommandType::DESTROY:
+			//Several threads can destroy the same entity
+			if(m_DestroyedEntities.empty() || m_DestroyedEntities.back() != command.entity)
+			{
+				m_DestroyedEntities.push_back(command.entity);
+			}
+			break;
+		default:
+			break;
+		}
+	}
+	if(!m_DestroyedEntities.empty())
+	{
+		DestroyEntities(m_DestroyedEntities);
+	}
+}
+
+void EntityManager::AddComponentFromCommand(Entity entity, ComponentType componentType)
+{
+	auto* componentFactory = m_Engine.GetSceneManager()->GetComponentFactory(componentType);
+	if(componentFactory == nullptr)
+	{
+		AddComponentType(entity, componentType);
+		return;
+	}
+	componentFactory->CreateDefaultComponent(entity);
+}
+
+void EntityManager::RemoveComponentFromCommand(Entity entity, ComponentType componentType)
+{
+	if(auto* componentFactory = m_Engine.GetSceneManager()->GetComponentFactory(componentType))
+	{
+		componentFactory->DestroyComponent(entity);
+	}
+	//Some managers keep their components when destroying them, the type is removed anyway
+	if(HasComponent(entity, componentType))
+	{
+		RemoveComponentType(entity, componentType);
+	}
+}
+
+void EntityManager::SaveSnapshot(Snapshot& snapshot) const
+{
+	const std::vector<unsigned char> entityAlive(m_EntityAlive.begin(), m_EntityAlive.end());
+	snapshot.WriteArray(m_MaskArray.data(), m_MaskArray.size());
+	snapshot.WriteArray(m_EntityVersions.data(), m_EntityVersions.size());
+	snapshot.WriteArray(entityAlive.data(), entityAlive.size());
+	snapshot.WriteArray(m_FreeEntityIndexes.data(), m_FreeEntityIndexes.size());
+}
+
+bool EntityManager::RestoreSnapshot(Snapshot& snapshot)
+{
+	size_t entityNmb = 0;
+	size_t versionNmb = 0;
+	size_t aliveNmb = 0;
+	size_t freeIndexNmb = 0;
+	const auto* masks = snapshot.ReadArray<EntityMask>(entityNmb);
+	const auto* versions = snapshot.ReadArray<unsigned>(versionNmb);
+	const auto* entityAlive = snapshot.ReadArray<unsigned char>(aliveNmb);
+	const auto* freeEntityIndexes = snapshot.ReadArray<size_t>(freeIndexNmb);
+	if(entityNmb != m_MaskArray.size() || versionNmb != entityNmb || aliveNmb != entityNmb)
+	{
+		Log::GetInstance()->Error("[Error] Snapshot was saved with another number of entities");
+		return false;
+	}
+	for(size_t entityIndex = 0; entityIndex < entityNmb; entityIndex++)
+	{
+		if(entityAlive[entityIndex] && (!m_EntityAlive[entityIndex] ||
+			m_EntityVersions[entityIndex] != versions[entityIndex] || m_MaskArray[entityIndex] != masks[entityIndex]))
+		{
+			std::ostringstream oss;
+			oss << "[Error] Entity " << entityIndex + 1 << " was destroyed or changed its components since the snapshot";
+			Log::GetInstance()->Error(oss.str());
+			return false;
+		}
+	}
+	for(size_t entityIndex = 0; entityIndex < entityNmb; entityIndex++)
+	{
+		if(!entityAlive[entityIndex] && m_EntityAlive[entityIndex])
+		{
+			DestroyEntity(MakeEntity(entityIndex, m_EntityVersions[entityIndex]));
+		}
+	}
+	m_EntityVersions.assign(versions, versions + versionNmb);
+	m_FreeEntityIndexes.assign(freeEntityIndexes, freeEntityIndexes + freeIndexNmb);
+	return true;
+}
+
+void EntityManager::ReleaseEntity(Entity entity)
+{
+	if (m_ArchetypeStorage != nullptr)
+	{
+		m_ArchetypeStorage->RemoveEntity(entity);
+	}
+	const auto entityIndex = GetEntityIndex(entity);
+	for(auto& query : m_Queries)
+	{
+		if(query->Matches(m_MaskArray[entityIndex]))
+		{
+			query->Remove(entity);
+		}
+	}
+	RemoveEntityName(entityIndex);
+	m_EntityInfos[entityIndex].name.clear();
+	m_MaskArray[entityIndex] = INVALID_ENTITY;
+	m_EntityAlive[entityIndex] = false;
+	m_EntityVersions[entityIndex] = (m_EntityVersions[entityIndex] + 1U) & ENTITY_VERSION_MASK;
+	m_FreeEntityIndexes.push_back(entityIndex);
+}
+
+bool EntityManager::IsEntityValid(Entity entity) const
+{
+	const auto entityIndex = GetEntityIndex(entity);
+	return entity != INVALID_ENTITY &&
+		entityIndex < m_MaskArray.size() &&
+		m_EntityAlive[entityIndex] &&
+		m_EntityVersions[entityIndex] == GetEntityVersion(entity);
+}
+
+Entity EntityManager::GetEntityByIndex(size_t entityIndex) const
+{
+	if(entityIndex >= m_MaskArray.size() || !m_EntityAlive[entityIndex])
 	{
-    	destroyObserver->OnDestroy(entity);
+		return INVALID_ENTITY;
 	}
-	m_MaskArray[entity-1] = INVALID_ENTITY;
+	return MakeEntity(entityIndex, m_EntityVersions[entityIndex]);
 }
 
 bool EntityManager::HasComponent(Entity entity, ComponentType componentType)
 {
-	return (m_MaskArray[entity - 1] & static_cast<int>(componentType)) == static_cast<int>(componentType);
+	if(!IsEntityValid(entity))
+	{
+		return false;
+	}
+	const auto entityIndex = GetEntityIndex(entity);
+	return (m_MaskArray[entityIndex] & static_cast<EntityMask>(componentType)) == static_cast<EntityMask>(componentType);
 }
 
 void EntityManager::AddComponentType(Entity entity, ComponentType componentType)
 {
-
-	m_MaskArray[entity - 1] = m_MaskArray[entity - 1] | static_cast<int>(componentType);
+	if(!IsEntityValid(entity))
+	{
+		std::ostringstream oss;
+		oss << "[Error] Trying to add a component type to invalid entity: " << entity;
+		Log::GetInstance()->Error(oss.str());
+		return;
+	}
+	const auto entityIndex = GetEntityIndex(entity);
+	const auto oldMask = m_MaskArray[entityIndex];
+	m_MaskArray[entityIndex] = oldMask | static_cast<EntityMask>(componentType);
+	for(auto& query : m_Queries)
+	{
+		if(!query->Matches(oldMask) && query->Matches(m_MaskArray[entityIndex]))
+		{
+			query->Add(entity);
+		}
+	}
 }
 
 void EntityManager::RemoveComponentType(Entity entity, ComponentType componentType)
 {
-	m_MaskArray[entity - 1] &= ~static_cast<int>(componentType);
+	if(!IsEntityValid(entity))
+	{
+		std::ostringstream oss;
+		oss << "[Error] Trying to remove a component type from invalid entity: " << entity;
+		Log::GetInstance()->Error(oss.str());
+		return;
+	}
+	const auto entityIndex = GetEntityIndex(entity);
+	const auto oldMask = m_MaskArray[entityIndex];
+	m_MaskArray[entityIndex] = oldMask & ~static_cast<EntityMask>(componentType);
+	for(auto& query : m_Queries)
+	{
+		if(query->Matches(oldMask) && !query->Matches(m_MaskArray[entityIndex]))
+		{
+			query->Remove(entity);
+		}
+	}
+}
+
+editor::EntityInfo* EntityManager::GetEntityInfo(Entity entity)
+{
+	if(!IsEntityValid(entity))
+	{
+		return nullptr;
+	}
+	return &m_EntityInfos[GetEntityIndex(entity)];
+}
+
+void EntityManager::SetEntityName(Entity entity, const std::string& entityName)
+{
+	if(!IsEntityValid(entity))
+	{
+		std::ostringstream oss;
+		oss << "[Error] Trying to name invalid entity: " << entity;
+		Log::GetInstance()->Error(oss.str());
+		return;
+	}
+	const auto entityIndex = GetEntityIndex(entity);
+	RemoveEntityName(entityIndex);
+	m_EntityInfos[entityIndex].name = entityName;
+	m_EntityNameIndex.emplace(entityName, entity);
 }
 
-editor::EntityInfo& EntityManager::GetEntityInfo(Entity entity)
+void EntityManager::SetEntitiesName(const std::vector<Entity>& entities, const std::string& entityName)
 {
-	return m_EntityInfos[entity - 1];
+	m_EntityNameIndex.reserve(m_EntityNameIndex.size() + entities.size());
+	for(auto entity : entities)
+	{
+		SetEntityName(entity, entityName);
+	}
 }
 
 Entity EntityManager::GetEntityByName(std::string entityName) const
 {
-	const auto entityNmb = m_EntityInfos.size();
-	for(int i = 0; i < entityNmb; i++)
+	//Several entities can share a name, return the one with the lowest index like a scan of the entities would
+	Entity foundEntity = INVALID_ENTITY;
+	const auto range = m_EntityNameIndex.equal_range(entityName);
+	for(auto it = range.first; it != range.second; ++it)
 	{
-		if(m_EntityInfos[i].name == entityName)
+		if(foundEntity == INVALID_ENTITY || GetEntityIndex(it->second) < GetEntityIndex(foundEntity))
 		{
-			return i + 1;
+			foundEntity = it->second;
 		}
 	}
-	return INVALID_ENTITY;
+	return foundEntity;
+}
+
+std::vector<Entity> EntityManager::GetEntitiesByName(const std::vector<std::string>& entityNames) const
+{
+	std::vector<Entity> entities;
+	entities.reserve(entityNames.size());
+	for(const auto& entityName : entityNames)
+	{
+		entities.push_back(GetEntityByName(entityName));
+	}
+	return entities;
 }
 
 void EntityManager::ResizeEntityNmb(size_t newSize)
 {
+	if(newSize > MAX_ENTITY_NMB)
+	{
+		std::ostringstream oss;
+		oss << "[Error] Entity number " << newSize << " is bigger than the maximum: " << MAX_ENTITY_NMB;
+		Log::GetInstance()->Error(oss.str());
+		newSize = MAX_ENTITY_NMB;
+	}
+	const auto oldSize = m_MaskArray.size();
+	for(auto entityIndex = newSize; entityIndex < m_EntityInfos.size(); entityIndex++)
+	{
+		RemoveEntityName(entityIndex);
+	}
 	m_MaskArray.resize(newSize);
 	m_EntityInfos.resize(newSize);
+	m_EntityVersions.resize(newSize, 0U);
+	m_EntityAlive.resize(newSize, false);
+	if(newSize < oldSize)
+	{
+		m_FreeEntityIndexes.erase(std::remove_if(m_FreeEntityIndexes.begin(), m_FreeEntityIndexes.end(),
+			[newSize](size_t entityIndex) { return entityIndex >= newSize; }), m_FreeEntityIndexes.end());
+	}
+	else
+	{
+		AddFreeEntityIndexes(oldSize, newSize);
+	}
 	for (auto* resizeObserver : m_ResizeObservers)
 	{
 		resizeObserver->OnResize(newSize);
@@ -144,18 +700,104 @@ void EntityManager::AddDestroyObserver(DestroyObserver *destroyObserver)
 	m_DestroyObservers.emplace(destroyObserver);
 }
 
-std::vector<Entity> EntityManager::GetEntitiesWithType(ComponentType componentType)
+void EntityManager::SetStructuralChangesLocked(bool locked)
+{
+	m_StructuralChangesLocked = locked;
+}
+
+bool EntityManager::AreStructuralChangesLocked() const
+{
+	return m_StructuralChangesLocked;
+}
+
+const std::vector<Entity>& EntityManager::GetEntitiesWithType(ComponentType componentType)
+{
+	return GetQuery(static_cast<EntityMask>(componentType)).GetEntities();
+}
+
+EntityQuery& EntityManager::GetQuery(EntityMask mask)
 {
-	std::vector<Entity> entitiesWithComponent;
-	entitiesWithComponent.reserve(m_MaskArray.size());
-	for(int i = 0; i<m_MaskArray.size();i++)
+	for(auto& query : m_Queries)
 	{
-		if(HasComponent(i+1, componentType))
+		if(query->GetMask() == mask)
 		{
-			entitiesWithComponent.push_back(i + 1);
+			return *query;
 		}
 	}
-	return entitiesWithComponent;
+	m_Queries.push_back(std::make_unique<EntityQuery>(mask));
+	auto& query = *m_Queries.back();
+	if(mask != 0)
+	{
+		ScanMasks(m_MaskArray.data(), m_MaskArray.size(), mask, 0, [this, &query](size_t entityIndex)
+		{
+			query.Add(MakeEntity(entityIndex, m_EntityVersions[entityIndex]));
+		});
+	}
+	else
+	{
+		for(size_t i = 0; i < m_MaskArray.size(); i++)
+		{
+			if(m_EntityAlive[i] && query.Matches(m_MaskArray[i]))
+			{
+				query.Add(MakeEntity(i, m_EntityVersions[i]));
+			}
+		}
+	}
+	return query;
+}
+
+void EntityManager::FindEntities(EntityMask requiredMask, EntityMask excludedMask, std::vector<Entity>& entities) const
+{
+	entities.clear();
+	ScanMasks(m_MaskArray.data(), m_MaskArray.size(), requiredMask, excludedMask,
+		[this, requiredMask, &entities](size_t entityIndex)
+	{
+		//Free entities have an empty mask and only match when nothing is required
+		if(requiredMask != 0 || m_EntityAlive[entityIndex])
+		{
+			entities.push_back(MakeEntity(entityIndex, m_EntityVersions[entityIndex]));
+		}
+	});
+}
+
+EntityQuery& EntityManager::GetQuery(const std::vector<ComponentType>& componentTypes)
+{
+	EntityMask mask = 0;
+	for(auto componentType : componentTypes)
+	{
+		mask |= static_cast<EntityMask>(componentType);
+	}
+	return GetQuery(mask);
+}
+
+ArchetypeStorage* EntityManager::GetArchetypeStorage()
+{
+	return m_ArchetypeStorage.get();
+}
+
+void EntityManager::RemoveEntityName(size_t entityIndex)
+{
+	const auto range = m_EntityNameIndex.equal_range(m_EntityInfos[entityIndex].name);
+	for(auto it = range.first; it != range.second; ++it)
+	{
+		if(GetEntityIndex(it->second) == entityIndex)
+		{
+			m_EntityNameIndex.erase(it);
+			return;
+		}
+	}
+}
+
+void EntityManager::AddFreeEntityIndexes(size_t begin, size_t end)
+{
+	//The free list is popped from the back, the new indexes go in front so the lowest index is reused first
+	std::vector<size_t> newIndexes;
+	newIndexes.reserve(end - begin);
+	for(auto entityIndex = end; entityIndex > begin; entityIndex--)
+	{
+		newIndexes.push_back(entityIndex - 1);
+	}
+	m_FreeEntityIndexes.insert(m_FreeEntityIndexes.begin(), newIndexes.begin(), newIndexes.end());
 }
 
 }
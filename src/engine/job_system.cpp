@@ -0,0 +1,233 @@
+/*
+MIT License
+
+Copyright (c) 2017 SAE Institute Switzerland AG
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <chrono>
+
+#include <engine/job_system.h>
+
+namespace sfge
+{
+
+namespace
+{
+thread_local const JobSystem* currentJobSystem = nullptr;
+thread_local size_t currentWorkerIndex = 0;
+}
+
+JobSystem::~JobSystem()
+{
+	Destroy();
+}
+
+void JobSystem::Init(size_t workerThreadNmb)
+{
+	Destroy();
+	m_Workers.resize(workerThreadNmb + 1);
+	for (auto& worker : m_Workers)
+	{
+		worker = std::make_unique<Worker>();
+		worker->jobRing = std::make_unique<Job[]>(JOB_RING_SIZE);
+	}
+	currentJobSystem = this;
+	currentWorkerIndex = 0;
+	m_Running = true;
+	m_Threads.reserve(workerThreadNmb);
+	for (size_t workerIndex = 1; workerIndex <= workerThreadNmb; workerIndex++)
+	{
+		m_Threads.emplace_back(&JobSystem::WorkerLoop, this, workerIndex);
+	}
+}
+
+void JobSystem::Destroy()
+{
+	if (m_Workers.empty())
+	{
+		return;
+	}
+	//Run what is left so no counter stays locked
+	while (auto* job = PopJob())
+	{
+		Execute(job);
+	}
+	{
+		std::lock_guard<std::mutex> lock(m_WakeMutex);
+		m_Running = false;
+	}
+	m_WakeCondition.notify_all();
+	for (auto& thread : m_Threads)
+	{
+		thread.join();
+	}
+	m_Threads.clear();
+	m_Workers.clear();
+	if (currentJobSystem == this)
+	{
+		currentJobSystem = nullptr;
+	}
+}
+
+void JobSystem::Wait(const JobCounter& counter)
+{
+	while (!counter.IsDone())
+	{
+		auto* job = PopJob();
+		if (job != nullptr)
+		{
+			Execute(job);
+		}
+		else
+		{
+			std::this_thread::yield();
+		}
+	}
+}
+
+size_t JobSystem::GetWorkerNmb() const
+{
+	return m_Workers.size();
+}
+
+Job* JobSystem::AllocateJob()
+{
+	//Jobs are recycled in a ring, a slot still in use means more than JOB_RING_SIZE jobs in flight
+	auto& worker = *m_Workers[GetCurrentWorkerIndex()];
+	auto* job = &worker.jobRing[worker.jobRingIndex];
+	worker.jobRingIndex = (worker.jobRingIndex + 1) % JOB_RING_SIZE;
+	while (job->inUse.load(std::memory_order_acquire))
+	{
+		//Help the other jobs until the old job of the slot is done
+		auto* pendingJob = PopJob();
+		if (pendingJob != nullptr)
+		{
+			Execute(pendingJob);
+		}
+		else
+		{
+			std::this_thread::yield();
+		}
+	}
+	job->inUse.store(true, std::memory_order_relaxed);
+	return job;
+}
+
+void JobSystem::PushJob(Job* job)
+{
+	auto& worker = *m_Workers[GetCurrentWorkerIndex()];
+	{
+		std::lock_guard<std::mutex> lock(worker.mutex);
+		worker.jobs.push_back(job);
+	}
+	m_PendingJobNmb.fetch_add(1, std::memory_order_release);
+	if (m_SleepingWorkerNmb.load(std::memory_order_acquire) > 0)
+	{
+		//Taking the wake mutex avoids losing the notification of a worker about to sleep
+		{
+			std::lock_guard<std::mutex> lock(m_WakeMutex);
+		}
+		m_WakeCondition.notify_one();
+	}
+}
+
+Job* JobSystem::PopJob()
+{
+	const size_t workerIndex = GetCurrentWorkerIndex();
+	auto& worker = *m_Workers[workerIndex];
+	{
+		std::lock_guard<std::mutex> lock(worker.mutex);
+		if (!worker.jobs.empty())
+		{
+			auto* job = worker.jobs.back();
+			worker.jobs.pop_back();
+			m_PendingJobNmb.fetch_sub(1, std::memory_order_relaxed);
+			return job;
+		}
+	}
+	return StealJob(workerIndex);
+}
+
+Job* JobSystem::StealJob(size_t thiefIndex)
+{
+	const size_t workerNmb = m_Workers.size();
+	for (size_t offset = 1; offset < workerNmb; offset++)
+	{
+		auto& victim = *m_Workers[(thiefIndex + offset) % workerNmb];
+		std::unique_lock<std::mutex> lock(victim.mutex, std::try_to_lock);
+		if (lock.owns_lock() && !victim.jobs.empty())
+		{
+			auto* job = victim.jobs.front();
+			victim.jobs.pop_front();
+			m_PendingJobNmb.fetch_sub(1, std::memory_order_relaxed);
+			return job;
+		}
+	}
+	return nullptr;
+}
+
+void JobSystem::Execute(Job* job)
+{
+	auto* counter = job->counter;
+	job->function(job->closure);
+	job->destructor(job->closure);
+	job->inUse.store(false, std::memory_order_release);
+	if (counter != nullptr)
+	{
+		counter->value.fetch_sub(1, std::memory_order_release);
+	}
+}
+
+void JobSystem::WorkerLoop(size_t workerIndex)
+{
+	currentJobSystem = this;
+	currentWorkerIndex = workerIndex;
+	while (m_Running.load(std::memory_order_acquire))
+	{
+		auto* job = PopJob();
+		if (job != nullptr)
+		{
+			Execute(job);
+			continue;
+		}
+		std::unique_lock<std::mutex> lock(m_WakeMutex);
+		m_SleepingWorkerNmb.fetch_add(1, std::memory_order_acq_rel);
+		//The timeout catches the jobs missed by a failed try_lock while stealing
+		m_WakeCondition.wait_for(lock, std::chrono::milliseconds(1), [this]
+		{
+			return !m_Running.load(std::memory_order_acquire) ||
+				m_PendingJobNmb.load(std::memory_order_acquire) > 0;
+		});
+		m_SleepingWorkerNmb.fetch_sub(1, std::memory_order_acq_rel);
+	}
+}
+
+size_t JobSystem::GetCurrentWorkerIndex() const
+{
+	return currentJobSystem == this ? currentWorkerIndex : 0;
+}
+
+bool JobSystem::IsWorkerThread() const
+{
+	return currentJobSystem == this;
+}
+
+}
@@ -24,6 +24,10 @@
 
 #include <engine/memory.h>
 
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
 namespace sfge
 {
 
@@ -50,7 +54,8 @@ void* LinearAllocator::allocate(size_t size, ptr_type alignment)
 
 void LinearAllocator::deallocate(void* p)
 {
-    assert( false && "Use clear() instead" );
+    //Containers give back their old buffer when growing, the memory is only reclaimed by clear()
+    (void) p;
 }
 
 void LinearAllocator::clear()
@@ -142,7 +147,8 @@ void* FreeListAllocator::allocate(size_t size, ptr_type alignment)
     {
         //Calculate adjustment needed to keep object correctly aligned 
         ptr_type adjustment = alignForwardAdjustmentWithHeader(free_block, alignment, sizeof(AllocationHeader));
-        size_t total_size = size + adjustment;
+        //Rounded up so the FreeBlock created after an allocation of odd size is still aligned
+        size_t total_size = (size + adjustment + alignof(FreeBlock) - 1) & ~(alignof(FreeBlock) - 1);
 
         //If allocation doesn't fit in this FreeBlock, try the next 
         if(free_block->size < total_size)
@@ -242,6 +248,229 @@ void FreeListAllocator::deallocate(void* p)
     _used_memory -= block_size;
 }
 
+namespace
+{
+//Index of the lowest set bit, the word must not be 0
+inline size_t findFirstSet(uint32_t word)
+{
+#ifdef _MSC_VER
+    unsigned long index;
+    _BitScanForward(&index, word);
+    return index;
+#else
+    return static_cast<size_t>(__builtin_ctz(word));
+#endif
+}
+
+//Index of the highest set bit, the word must not be 0
+inline size_t findLastSet(size_t word)
+{
+#ifdef _MSC_VER
+    unsigned long index;
+    _BitScanReverse64(&index, static_cast<unsigned long long>(word));
+    return index;
+#else
+    return sizeof(unsigned long long) * 8 - 1 - static_cast<size_t>(__builtin_clzll(word));
+#endif
+}
+
+inline size_t alignUp(size_t size, size_t alignment)
+{
+    return (size + alignment - 1) & ~(alignment - 1);
+}
+}
+
+TlsfAllocator::TlsfAllocator(size_t size, void* start) : Allocator(size, start), _fl_bitmap(0)
+{
+    for(size_t fl = 0; fl < FL_INDEX_COUNT; fl++)
+    {
+        _sl_bitmap[fl] = 0;
+        for(size_t sl = 0; sl < SL_INDEX_COUNT; sl++)
+        {
+            _blocks[fl][sl] = nullptr;
+        }
+    }
+    const ptr_type adjustment = alignForwardAdjustment(start, ALIGN_SIZE);
+    assert(size > adjustment + 2 * BLOCK_OVERHEAD + BLOCK_SIZE_MIN);
+    size_t blockSize = (size - adjustment - 2 * BLOCK_OVERHEAD) & ~(ALIGN_SIZE - 1);
+    if(blockSize >= BLOCK_SIZE_MAX)
+        blockSize = BLOCK_SIZE_MAX - ALIGN_SIZE;
+
+    auto* block = (BlockHeader*)((ptr_type)start + adjustment);
+    block->prev_physical = nullptr;
+    block->size = blockSize | 1;
+    //Used block of size 0 closing the memory so the last block never looks for a next neighbour outside
+    auto* sentinel = (BlockHeader*)((ptr_type)block + BLOCK_OVERHEAD + blockSize);
+    sentinel->prev_physical = block;
+    sentinel->size = 0;
+    insertFreeBlock(block);
+}
+
+TlsfAllocator::~TlsfAllocator()
+{
+    _fl_bitmap = 0;
+}
+
+void TlsfAllocator::mapping(size_t size, size_t& fl, size_t& sl)
+{
+    if(size < SMALL_BLOCK_SIZE)
+    {
+        //The small sizes are split linearly in the first list
+        fl = 0;
+        sl = size / (SMALL_BLOCK_SIZE / SL_INDEX_COUNT);
+    }
+    else
+    {
+        const size_t lastSet = findLastSet(size);
+        sl = (size >> (lastSet - SL_INDEX_COUNT_LOG2)) ^ SL_INDEX_COUNT;
+        fl = lastSet - (FL_INDEX_SHIFT - 1);
+    }
+}
+
+TlsfAllocator::BlockHeader* TlsfAllocator::findSuitableBlock(size_t size)
+{
+    //Round up to the next class, any block in it is then large enough
+    if(size >= SMALL_BLOCK_SIZE)
+        size += (size_t(1) << (findLastSet(size) - SL_INDEX_COUNT_LOG2)) - 1;
+    size_t fl, sl;
+    mapping(size, fl, sl);
+    if(fl >= FL_INDEX_COUNT)
+        return nullptr;
+
+    uint32_t slMap = _sl_bitmap[fl] & (~0u << sl);
+    if(slMap == 0)
+    {
+        //No block in this first level, take the smallest class of the next non empty one
+        const uint32_t flMap = fl + 1 < FL_INDEX_COUNT ? _fl_bitmap & (~0u << (fl + 1)) : 0;
+        if(flMap == 0)
+            return nullptr;
+        fl = findFirstSet(flMap);
+        slMap = _sl_bitmap[fl];
+    }
+    sl = findFirstSet(slMap);
+    return _blocks[fl][sl];
+}
+
+void TlsfAllocator::insertFreeBlock(BlockHeader* block)
+{
+    size_t fl, sl;
+    mapping(block->size & ~size_t(1), fl, sl);
+    BlockHeader* head = _blocks[fl][sl];
+    block->next_free = head;
+    block->prev_free = nullptr;
+    if(head != nullptr)
+        head->prev_free = block;
+    _blocks[fl][sl] = block;
+    _fl_bitmap |= 1u << fl;
+    _sl_bitmap[fl] |= 1u << sl;
+}
+
+void TlsfAllocator::removeFreeBlock(BlockHeader* block)
+{
+    size_t fl, sl;
+    mapping(block->size & ~size_t(1), fl, sl);
+    if(block->prev_free != nullptr)
+        block->prev_free->next_free = block->next_free;
+    else
+        _blocks[fl][sl] = block->next_free;
+    if(block->next_free != nullptr)
+        block->next_free->prev_free = block->prev_free;
+
+    if(_blocks[fl][sl] == nullptr)
+    {
+        _sl_bitmap[fl] &= ~(1u << sl);
+        if(_sl_bitmap[fl] == 0)
+            _fl_bitmap &= ~(1u << fl);
+    }
+}
+
+TlsfAllocator::BlockHeader* TlsfAllocator::splitBlock(BlockHeader* block, size_t size)
+{
+    const size_t blockSize = block->size & ~size_t(1);
+    auto* remaining = (BlockHeader*)((ptr_type)block + BLOCK_OVERHEAD + size);
+    remaining->prev_physical = block;
+    remaining->size = blockSize - size - BLOCK_OVERHEAD;
+    auto* next = (BlockHeader*)((ptr_type)remaining + BLOCK_OVERHEAD + remaining->size);
+    next->prev_physical = remaining;
+    block->size = size | (block->size & 1);
+    return remaining;
+}
+
+void* TlsfAllocator::allocate(size_t size, ptr_type alignment)
+{
+    assert(size != 0);
+    const size_t align = alignment > (ptr_type)ALIGN_SIZE ? (size_t)alignment : ALIGN_SIZE;
+    size = alignUp(size > BLOCK_SIZE_MIN ? size : BLOCK_SIZE_MIN, ALIGN_SIZE);
+    //Room to move the payload to the alignment, leaving in front a gap large enough to be a free block
+    const size_t gapSize = align > ALIGN_SIZE ? align + sizeof(BlockHeader) : 0;
+    if(size + gapSize >= BLOCK_SIZE_MAX)
+        return nullptr;
+
+    BlockHeader* block = findSuitableBlock(size + gapSize);
+    if(block == nullptr)
+        return nullptr;
+    removeFreeBlock(block);
+
+    if(gapSize > 0)
+    {
+        const ptr_type payload = (ptr_type)block + BLOCK_OVERHEAD;
+        ptr_type alignedPayload = (ptr_type)alignForward((void*)payload, align);
+        if(alignedPayload != payload && (size_t)(alignedPayload - payload) < sizeof(BlockHeader))
+            alignedPayload = (ptr_type)alignForward((void*)(payload + sizeof(BlockHeader)), align);
+        const size_t gap = alignedPayload - payload;
+        if(gap > 0)
+        {
+            //The previous block is used as the free blocks are always merged, the gap becomes a free block on its own
+            BlockHeader* alignedBlock = splitBlock(block, gap - BLOCK_OVERHEAD);
+            insertFreeBlock(block);
+            block = alignedBlock;
+            block->size |= 1;
+        }
+    }
+
+    if((block->size & ~size_t(1)) >= size + sizeof(BlockHeader))
+    {
+        //The next block is used for the same reason, the trimmed end does not need to be merged
+        BlockHeader* remaining = splitBlock(block, size);
+        remaining->size |= 1;
+        insertFreeBlock(remaining);
+    }
+    block->size &= ~size_t(1);
+    _used_memory += block->size + BLOCK_OVERHEAD;
+    _num_allocations++;
+    return (void*)((ptr_type)block + BLOCK_OVERHEAD);
+}
+
+void TlsfAllocator::deallocate(void* p)
+{
+    assert(p != nullptr);
+    auto* block = (BlockHeader*)((ptr_type)p - BLOCK_OVERHEAD);
+    assert((block->size & 1) == 0 && "Double free in TlsfAllocator");
+    _used_memory -= block->size + BLOCK_OVERHEAD;
+    _num_allocations--;
+
+    BlockHeader* prev = block->prev_physical;
+    if(prev != nullptr && (prev->size & 1))
+    {
+        removeFreeBlock(prev);
+        prev->size += BLOCK_OVERHEAD + block->size;
+        block = prev;
+    }
+    else
+    {
+        block->size |= 1;
+    }
+    auto* next = (BlockHeader*)((ptr_type)block + BLOCK_OVERHEAD + (block->size & ~size_t(1)));
+    if(next->size & 1)
+    {
+        removeFreeBlock(next);
+        block->size += BLOCK_OVERHEAD + (next->size & ~size_t(1));
+        next = (BlockHeader*)((ptr_type)block + BLOCK_OVERHEAD + (block->size & ~size_t(1)));
+    }
+    next->prev_physical = block;
+    insertFreeBlock(block);
+}
+
 PoolAllocator::PoolAllocator(size_t objectSize, ptr_type objectAlignment, size_t size, void* mem) : Allocator(size, mem), _objectSize(objectSize), _objectAlignment(objectAlignment)
 {
     assert(objectSize >= sizeof(void*));
@@ -286,6 +515,154 @@ void PoolAllocator::deallocate(void* p)
     _num_allocations--;
 }
 
+ConcurrentPoolAllocator::ConcurrentPoolAllocator(size_t objectSize, ptr_type objectAlignment, size_t size, void* mem, size_t threadNmb) :
+    Allocator(size, mem), _head(0), _allocated_object_nmb(0), _caches(new ThreadCache[threadNmb > 0 ? threadNmb : 1]),
+    _cache_nmb(threadNmb > 0 ? threadNmb : 1)
+{
+    assert(objectSize != 0);
+    const ptr_type alignment = objectAlignment > 0 ? objectAlignment : 1;
+    const ptr_type adjustment = alignForwardAdjustment(mem, alignment);
+    _objects = (void*)((ptr_type)mem + adjustment);
+    _stride = (objectSize + alignment - 1) & ~(size_t)(alignment - 1);
+    _object_nmb = (size - adjustment) / _stride;
+    assert(_object_nmb > 0 && _object_nmb < INVALID_INDEX);
+
+    //Initialize free blocks list
+    _links.reset(new std::atomic<uint32_t>[_object_nmb]);
+    for(uint32_t i = 0; i < _object_nmb; i++)
+    {
+        _links[i].store(i + 1 < _object_nmb ? i + 1 : INVALID_INDEX, std::memory_order_relaxed);
+    }
+    _head.store(0, std::memory_order_relaxed);
+}
+
+ConcurrentPoolAllocator::~ConcurrentPoolAllocator()
+{
+    assert(_allocated_object_nmb.load() == 0);
+    _objects = nullptr;
+}
+
+void* ConcurrentPoolAllocator::getObject(uint32_t index) const
+{
+    return (void*)((ptr_type)_objects + (ptr_type)(index * _stride));
+}
+
+uint32_t ConcurrentPoolAllocator::getIndex(const void* p) const
+{
+    assert((ptr_type)p >= (ptr_type)_objects && ((ptr_type)p - (ptr_type)_objects) % _stride == 0);
+    return (uint32_t)(((ptr_type)p - (ptr_type)_objects) / _stride);
+}
+
+std::atomic<uint32_t>& ConcurrentPoolAllocator::getNext(uint32_t index) const
+{
+    return _links[index];
+}
+
+uint32_t ConcurrentPoolAllocator::pop()
+{
+    uint64_t head = _head.load(std::memory_order_acquire);
+    while(true)
+    {
+        const auto index = (uint32_t)head;
+        if(index == INVALID_INDEX)
+            return INVALID_INDEX;
+        //The object might be popped and its link rewritten by another thread meanwhile, the tag then makes the swap fail
+        const uint32_t next = getNext(index).load(std::memory_order_relaxed);
+        const uint64_t newHead = (((head >> 32) + 1) << 32) | next;
+        if(_head.compare_exchange_weak(head, newHead, std::memory_order_acquire, std::memory_order_acquire))
+            return index;
+    }
+}
+
+void ConcurrentPoolAllocator::push(uint32_t first, uint32_t last)
+{
+    uint64_t head = _head.load(std::memory_order_relaxed);
+    while(true)
+    {
+        getNext(last).store((uint32_t)head, std::memory_order_relaxed);
+        const uint64_t newHead = (((head >> 32) + 1) << 32) | first;
+        if(_head.compare_exchange_weak(head, newHead, std::memory_order_release, std::memory_order_relaxed))
+            return;
+    }
+}
+
+void* ConcurrentPoolAllocator::allocate(size_t size, ptr_type alignment)
+{
+    assert(size <= _stride);
+    (void) alignment;
+    const uint32_t index = pop();
+    if(index == INVALID_INDEX)
+        return nullptr;
+    _allocated_object_nmb.fetch_add(1, std::memory_order_relaxed);
+    return getObject(index);
+}
+
+void ConcurrentPoolAllocator::deallocate(void* p)
+{
+    assert(p != nullptr);
+    const uint32_t index = getIndex(p);
+    _allocated_object_nmb.fetch_sub(1, std::memory_order_relaxed);
+    push(index, index);
+}
+
+void* ConcurrentPoolAllocator::allocate(size_t threadIndex)
+{
+    assert(threadIndex < _cache_nmb);
+    ThreadCache& cache = _caches[threadIndex];
+    if(cache.count == 0)
+    {
+        while(cache.count < CACHE_BATCH)
+        {
+            const uint32_t index = pop();
+            if(index == INVALID_INDEX)
+                break;
+            cache.indexes[cache.count++] = index;
+        }
+        if(cache.count == 0)
+            return nullptr;
+    }
+    _allocated_object_nmb.fetch_add(1, std::memory_order_relaxed);
+    return getObject(cache.indexes[--cache.count]);
+}
+
+void ConcurrentPoolAllocator::deallocate(void* p, size_t threadIndex)
+{
+    assert(p != nullptr && threadIndex < _cache_nmb);
+    ThreadCache& cache = _caches[threadIndex];
+    if(cache.count == CACHE_SIZE)
+    {
+        //Link the oldest half of the cache and give it back in one swap
+        for(size_t i = 0; i + 1 < CACHE_BATCH; i++)
+        {
+            getNext(cache.indexes[i]).store(cache.indexes[i + 1], std::memory_order_relaxed);
+        }
+        push(cache.indexes[0], cache.indexes[CACHE_BATCH - 1]);
+        for(size_t i = CACHE_BATCH; i < CACHE_SIZE; i++)
+        {
+            cache.indexes[i - CACHE_BATCH] = cache.indexes[i];
+        }
+        cache.count -= CACHE_BATCH;
+    }
+    _allocated_object_nmb.fetch_sub(1, std::memory_order_relaxed);
+    cache.indexes[cache.count++] = getIndex(p);
+}
+
+void ConcurrentPoolAllocator::flushCaches()
+{
+    for(size_t cacheIndex = 0; cacheIndex < _cache_nmb; cacheIndex++)
+    {
+        ThreadCache& cache = _caches[cacheIndex];
+        for(size_t i = 0; i < cache.count; i++)
+        {
+            push(cache.indexes[i], cache.indexes[i]);
+        }
+        cache.count = 0;
+    }
+    //Only written here, the threads count in the atomic while they use the pool
+    _num_allocations = getAllocatedObjectNmb();
+    _used_memory = _num_allocations * _stride;
+}
+
 ProxyAllocator::ProxyAllocator(Allocator& allocator) : Allocator(allocator.getSize(), allocator.getStart()), _allocator(allocator) { }
 
 ProxyAllocator::~ProxyAllocator() { }
@@ -309,4 +686,30 @@ void ProxyAllocator::deallocate(void* p)
     _used_memory -= mem - _allocator.getUsedMemory();
 }
 
+void* AllocatorResource::do_allocate(size_t bytes, size_t alignment)
+{
+    //The containers ask for the alignment of their type, as low as 1 for chars,
+    //but the headers the FreeListAllocator writes before each block need a natural alignment
+    if(alignment < alignof(std::max_align_t))
+        alignment = alignof(std::max_align_t);
+    //The sfge allocators do not accept empty allocations, the standard allows them
+    void* p = _allocator.allocate(bytes > 0 ? bytes : 1, static_cast<ptr_type>(alignment));
+    if(p == nullptr)
+        throw std::bad_alloc();
+    return p;
+}
+
+void AllocatorResource::do_deallocate(void* p, size_t bytes, size_t alignment)
+{
+    (void) bytes;
+    (void) alignment;
+    _allocator.deallocate(p);
+}
+
+bool AllocatorResource::do_is_equal(const std::pmr::memory_resource& other) const noexcept
+{
+    const auto* otherResource = dynamic_cast<const AllocatorResource*>(&other);
+    return otherResource != nullptr && &otherResource->_allocator == &_allocator;
+}
+
 }
\ No newline at end of file
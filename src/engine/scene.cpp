@@ -208,13 +208,13 @@ void SceneManager::LoadSceneFromJson(json& sceneJson, std::unique_ptr<editor::Sc
 			}
 			if(CheckJsonExists(entityJson, "name"))
 			{
-				m_EntityManager->GetEntityInfo(entity).name = entityJson["name"].get<std::string>();
+				m_EntityManager->SetEntityName(entity, entityJson["name"].get<std::string>());
 			}
 			else
 			{
 				std::ostringstream oss;
 				oss << "Entity " << entity;
-				m_EntityManager->GetEntityInfo(entity).name = oss.str();
+				m_EntityManager->SetEntityName(entity, oss.str());
 			}
 			if (entity != INVALID_ENTITY && 
 				CheckJsonExists(entityJson, "components"))
@@ -225,7 +225,14 @@ void SceneManager::LoadSceneFromJson(json& sceneJson, std::unique_ptr<editor::Sc
 					if (CheckJsonExists(componentJson, "type"))
 					{
 						const ComponentType componentType = componentJson["type"];
-						const auto index = static_cast<int>(log2(static_cast<double>(componentType)));
+						if(!IsComponentType(componentType))
+						{
+							std::ostringstream oss;
+							oss << "[Error] Unknown component type in json content: " << componentJson;
+							Log::GetInstance()->Error(oss.str());
+							continue;
+						}
+						const auto index = GetComponentTypeIndex(componentType);
 						if(m_ComponentManager[index] != nullptr)
 						{
 							m_ComponentManager[index]->CreateComponent(componentJson, entity);
@@ -309,9 +316,94 @@ void SceneManager::LoadSceneFromName(const std::string& sceneName)
 }
 void SceneManager::AddComponentManager(IComponentFactory *componentFactory, ComponentType componentType)
 {
-	const auto index = static_cast<int>(log2((double)componentType));
-	m_ComponentManager[index] = componentFactory;
+	m_ComponentManager[GetComponentTypeIndex(componentType)] = componentFactory;
+}
+IComponentFactory* SceneManager::GetComponentFactory(ComponentType componentType)
+{
+	if(!IsComponentType(componentType))
+	{
+		return nullptr;
+	}
+	return m_ComponentManager[GetComponentTypeIndex(componentType)];
+}
+Prefab SceneManager::CompilePrefab(const json& entityJson)
+{
+	Prefab prefab;
+	if(CheckJsonExists(entityJson, "name"))
+	{
+		prefab.name = entityJson["name"].get<std::string>();
+	}
+	if(!CheckJsonExists(entityJson, "components"))
+	{
+		std::ostringstream oss;
+		oss << "[Error] No components in the prefab json: " << entityJson;
+		Log::GetInstance()->Error(oss.str());
+		return prefab;
+	}
+	for(auto& componentJson : entityJson["components"])
+	{
+		if(!CheckJsonExists(componentJson, "type"))
+		{
+			std::ostringstream oss;
+			oss << "[Error] No type specified for component with json content: " << componentJson;
+			Log::GetInstance()->Error(oss.str());
+			continue;
+		}
+		const ComponentType componentType = componentJson["type"];
+		if(!IsComponentType(componentType) || m_ComponentManager[GetComponentTypeIndex(componentType)] == nullptr)
+		{
+			std::ostringstream oss;
+			oss << "[Error] Unknown component type in prefab json: " << componentJson;
+			Log::GetInstance()->Error(oss.str());
+			continue;
+		}
+		prefab.components.push_back(componentJson);
+		prefab.componentTypes.push_back(componentType);
+	}
+	return prefab;
 }
+
+Prefab SceneManager::LoadPrefabFromPath(const std::string& prefabPath)
+{
+	const auto prefabJsonPtr = LoadJson(prefabPath);
+	if(prefabJsonPtr == nullptr)
+	{
+		std::ostringstream oss;
+		oss << "[Error] Invalid JSON format for prefab: " << prefabPath;
+		Log::GetInstance()->Error(oss.str());
+		return Prefab();
+	}
+	return CompilePrefab(*prefabJsonPtr);
+}
+
+std::vector<Entity> SceneManager::InstantiatePrefab(Prefab& prefab, size_t count,
+	const std::function<void(Entity, size_t)>& initializer)
+{
+	rmt_ScopedCPUSample(InstantiatePrefab, 0);
+	auto entities = m_EntityManager->CreateEntities(count);
+	if(!prefab.name.empty())
+	{
+		m_EntityManager->SetEntitiesName(entities, prefab.name);
+	}
+	for(size_t i = 0; i < prefab.components.size(); i++)
+	{
+		const auto componentType = prefab.componentTypes[i];
+		m_ComponentManager[GetComponentTypeIndex(componentType)]->CreateComponents(prefab.components[i], entities);
+		for(auto entity : entities)
+		{
+			m_EntityManager->AddComponentType(entity, componentType);
+		}
+	}
+	if(initializer)
+	{
+		for(size_t i = 0; i < entities.size(); i++)
+		{
+			initializer(entities[i], i);
+		}
+	}
+	return entities;
+}
+
 void SceneManager::OnUpdate(float dt)
 {
 	rmt_ScopedCPUSample(PySceneSystemUpdate,0);
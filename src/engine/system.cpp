@@ -4,6 +4,7 @@
 
 #include <engine/system.h>
 #include <physics/collider2d.h>
+#include <engine/engine.h>
 
 namespace sfge
 {
@@ -44,6 +45,16 @@ Engine& System::GetEngine() const
 	return m_Engine;
 }
 
+LinearAllocator& System::GetFrameAllocator() const
+{
+	return m_Engine.GetFrameAllocator();
+}
+
+AllocatorResource& System::GetFrameResource() const
+{
+	return m_Engine.GetFrameResource();
+}
+
 bool System::GetInitlialized() const
 {
 	return m_Initialized;
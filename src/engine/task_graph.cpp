@@ -0,0 +1,133 @@
+/*
+MIT License
+
+Copyright (c) 2017 SAE Institute Switzerland AG
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <algorithm>
+
+#include <engine/task_graph.h>
+#include <Remotery.h>
+
+namespace sfge
+{
+
+TaskId TaskGraph::AddTask(const std::string& name, std::function<void()> task,
+	EntityMask readMask, EntityMask writeMask, bool mainThread)
+{
+	Task newTask;
+	newTask.name = name;
+	newTask.function = std::move(task);
+	newTask.readMask = readMask;
+	newTask.writeMask = writeMask;
+	newTask.mainThread = mainThread;
+	m_Tasks.push_back(std::move(newTask));
+	return static_cast<TaskId>(m_Tasks.size() - 1);
+}
+
+void TaskGraph::Build()
+{
+	m_Waves.clear();
+	m_TaskWaves.assign(m_Tasks.size(), 0);
+	for (TaskId taskId = 0u; taskId < m_Tasks.size(); taskId++)
+	{
+		size_t wave = 0;
+		for (TaskId previousTaskId = 0u; previousTaskId < taskId; previousTaskId++)
+		{
+			if (IsConflicting(m_Tasks[previousTaskId], m_Tasks[taskId]))
+			{
+				wave = std::max(wave, m_TaskWaves[previousTaskId] + 1);
+			}
+		}
+		m_TaskWaves[taskId] = wave;
+		if (wave >= m_Waves.size())
+		{
+			m_Waves.resize(wave + 1);
+		}
+		m_Waves[wave].push_back(taskId);
+	}
+}
+
+void TaskGraph::Execute(JobSystem& jobSystem)
+{
+	for (auto& wave : m_Waves)
+	{
+		JobCounter waveCounter;
+		//Schedule the worker tasks first so they run while the main thread tasks are executed
+		for (auto taskId : wave)
+		{
+			const auto* task = &m_Tasks[taskId];
+			if (!task->mainThread && wave.size() > 1)
+			{
+				jobSystem.Schedule([task]
+				{
+					RunTask(*task);
+				}, &waveCounter);
+			}
+		}
+		for (auto taskId : wave)
+		{
+			const auto& task = m_Tasks[taskId];
+			if (task.mainThread || wave.size() == 1)
+			{
+				RunTask(task);
+			}
+		}
+		jobSystem.Wait(waveCounter);
+	}
+}
+
+void TaskGraph::Clear()
+{
+	m_Tasks.clear();
+	m_Waves.clear();
+	m_TaskWaves.clear();
+}
+
+size_t TaskGraph::GetTaskNmb() const
+{
+	return m_Tasks.size();
+}
+
+size_t TaskGraph::GetWaveNmb() const
+{
+	return m_Waves.size();
+}
+
+size_t TaskGraph::GetTaskWave(TaskId taskId) const
+{
+	return m_TaskWaves[taskId];
+}
+
+bool TaskGraph::IsConflicting(const Task& task, const Task& otherTask)
+{
+	return (task.writeMask & (otherTask.readMask | otherTask.writeMask)) != 0 ||
+		(task.readMask & otherTask.writeMask) != 0;
+}
+
+void TaskGraph::RunTask(const Task& task)
+{
+	rmt_BeginCPUSampleDynamic(task.name.c_str(), 0);
+	task.function();
+	rmt_EndCPUSample();
+}
+
+}
@@ -6,68 +6,706 @@
  */
 
 
+#include <algorithm>
+
 #include <engine/transform2d.h>
+#include <engine/snapshot.h>
+#include <engine/transform2d_soa.h>
 #include <imgui.h>
 #include <engine/engine.h>
 namespace sfge
 {
+
+static sf::Transform GetLocalMatrix(const Transform2d& transform)
+{
+	sf::Transform matrix;
+	matrix.translate(transform.Position).rotate(transform.EulerAngle).scale(transform.Scale);
+	return matrix;
+}
+
+/**
+ * \brief World transform of a child from the world transform of its parent and its transform relative to it
+ */
+static Transform2d CombineTransforms(const Transform2d& parentTransform, const sf::Transform& parentMatrix, const Transform2d& transform)
+{
+	Transform2d worldTransform;
+	worldTransform.Position = parentMatrix.transformPoint(transform.Position);
+	worldTransform.Scale = Vec2f(parentTransform.Scale.x * transform.Scale.x, parentTransform.Scale.y * transform.Scale.y);
+	worldTransform.EulerAngle = parentTransform.EulerAngle + transform.EulerAngle;
+	return worldTransform;
+}
+
 void editor::Transform2dInfo::DrawOnInspector()
 {
-	auto* transform = transformManager->GetComponentPtr(m_Entity);
-	float pos[2] = { transform->Position.x, transform->Position.y };
+	auto transform = transformManager->GetComponentRef(m_Entity);
+	if (!transform.IsValid())
+	{
+		return;
+	}
+	const auto position = transform.GetPosition();
+	float pos[2] = { position.x, position.y };
 	ImGui::Separator();
 	ImGui::Text("Transform");
 	ImGui::InputFloat2("Position", pos);
-	float scale[2] = { transform->Scale.x, transform->Scale.y };
+	const auto transformScale = transform.GetScale();
+	float scale[2] = { transformScale.x, transformScale.y };
 	ImGui::InputFloat2("Scale", scale);
-	ImGui::InputFloat("Angle", &transform->EulerAngle);
+	float angle = transform.GetEulerAngle();
+	if (ImGui::InputFloat("Angle", &angle))
+	{
+		transform.SetEulerAngle(angle);
+	}
 }
 
+Transform2dRef::Transform2dRef(Transform2dManager* transformManager, Entity entity) :
+	m_TransformManager(transformManager), m_Entity(entity)
+{
+}
 
-Transform2d* Transform2dManager::AddComponent(Entity entity)
+bool Transform2dRef::IsValid() const
+{
+	return m_TransformManager != nullptr && m_TransformManager->HasTransform(m_Entity);
+}
+
+Entity Transform2dRef::GetEntity() const
+{
+	return m_Entity;
+}
+
+Transform2d Transform2dRef::Get() const
+{
+	return m_TransformManager->GetLocalTransform(m_Entity);
+}
+
+void Transform2dRef::Set(const Transform2d& transform)
+{
+	m_TransformManager->SetLocalTransform(m_Entity, transform);
+}
+
+Vec2f Transform2dRef::GetPosition() const
+{
+	return Get().Position;
+}
+
+void Transform2dRef::SetPosition(Vec2f position)
+{
+	if (m_TransformManager->m_SoAStorage)
+	{
+		const auto soaIndex = m_TransformManager->GetSoAIndex(m_Entity);
+		if (soaIndex != Transform2dManager::INVALID_SOA_INDEX)
+		{
+			m_TransformManager->m_SoA.positionsX[soaIndex] = position.x;
+			m_TransformManager->m_SoA.positionsY[soaIndex] = position.y;
+		}
+	}
+	else if (auto* transform = m_TransformManager->m_Components.Get(m_Entity))
+	{
+		transform->Position = position;
+	}
+}
+
+Vec2f Transform2dRef::GetScale() const
 {
+	return Get().Scale;
+}
 
-	auto& transform = GetComponentRef(entity);
-	m_Engine.GetEntityManager()->AddComponentType(entity, ComponentType::TRANSFORM2D);
-	auto& transformInfo = GetComponentInfo(entity);
-	transformInfo.SetEntity(entity);
-	transformInfo.transformManager = this;
-	return &transform;
+void Transform2dRef::SetScale(Vec2f scale)
+{
+	if (m_TransformManager->m_SoAStorage)
+	{
+		const auto soaIndex = m_TransformManager->GetSoAIndex(m_Entity);
+		if (soaIndex != Transform2dManager::INVALID_SOA_INDEX)
+		{
+			m_TransformManager->m_SoA.scalesX[soaIndex] = scale.x;
+			m_TransformManager->m_SoA.scalesY[soaIndex] = scale.y;
+		}
+	}
+	else if (auto* transform = m_TransformManager->m_Components.Get(m_Entity))
+	{
+		transform->Scale = scale;
+	}
+}
+
+float Transform2dRef::GetEulerAngle() const
+{
+	return Get().EulerAngle;
+}
+
+void Transform2dRef::SetEulerAngle(float eulerAngle)
+{
+	if (m_TransformManager->m_SoAStorage)
+	{
+		const auto soaIndex = m_TransformManager->GetSoAIndex(m_Entity);
+		if (soaIndex != Transform2dManager::INVALID_SOA_INDEX)
+		{
+			m_TransformManager->m_SoA.angles[soaIndex] = eulerAngle;
+		}
+	}
+	else if (auto* transform = m_TransformManager->m_Components.Get(m_Entity))
+	{
+		transform->EulerAngle = eulerAngle;
+	}
+}
+
+void Transform2dManager::OnEngineInit()
+{
+	SingleComponentManager::OnEngineInit();
+	const auto* config = m_Engine.GetConfig();
+	if (config != nullptr && config->transformSoA)
+	{
+		if (m_Components.IsArchetypeStorage())
+		{
+			Log::GetInstance()->Error("[Error] The transforms cannot be stored in arrays with the archetype storage");
+			return;
+		}
+		m_SoAStorage = true;
+	}
+}
+
+Transform2d* Transform2dManager::AddComponent(Entity entity)
+{
+	Transform2d* transform = nullptr;
+	if (m_SoAStorage)
+	{
+		if (!m_EntityManager->IsEntityValid(entity))
+		{
+			std::ostringstream oss;
+			oss << "[Error] Trying to create a component for invalid entity: " << entity;
+			Log::GetInstance()->Error(oss.str());
+			return nullptr;
+		}
+		const auto index = GetEntityIndex(entity);
+		if (index >= m_SoAIndexes.size())
+		{
+			ResizeTransformArrays(index + 1);
+		}
+		if (GetSoAIndex(entity) == INVALID_SOA_INDEX)
+		{
+			if (m_SoAIndexes[index] != INVALID_SOA_INDEX)
+			{
+				std::ostringstream oss;
+				oss << "[Error] Entity " << entity << " reuses the index of an entity whose component was not removed";
+				Log::GetInstance()->Error(oss.str());
+				return nullptr;
+			}
+			m_SoAIndexes[index] = m_SoA.Add(entity, Transform2d());
+		}
+		if (!m_EntityManager->HasComponent(entity, ComponentType::TRANSFORM2D))
+		{
+			m_EntityManager->AddComponentType(entity, ComponentType::TRANSFORM2D);
+		}
+	}
+	else
+	{
+		transform = GetOrCreateComponent(entity);
+		if (transform == nullptr)
+		{
+			return nullptr;
+		}
+	}
+	if (auto* transformInfo = GetComponentInfo(entity))
+	{
+		transformInfo->SetEntity(entity);
+		transformInfo->transformManager = this;
+	}
+	const auto index = GetEntityIndex(entity);
+	if (index >= m_ChangeVersions.size())
+	{
+		ResizeTransformArrays(index + 1);
+	}
+	m_PreviousValid[index] = false;
+	//Seen as changed by the next OnUpdate even if the new transform equals the last one of the index
+	m_ChangeVersions[index] = m_FrameVersion + 1;
+	return transform;
 }
 
 void Transform2dManager::CreateComponent(json& componentJson, Entity entity)
 {
 
 	//Log::GetInstance()->Msg("Create component Transform");
-	auto* transform = AddComponent(entity);
+	AddComponent(entity);
+	if (!HasTransform(entity))
+	{
+		return;
+	}
+	auto transform = GetLocalTransform(entity);
 	if (CheckJsonExists(componentJson, "position"))
-		transform->Position = GetVectorFromJson(componentJson, "position");
+		transform.Position = GetVectorFromJson(componentJson, "position");
 	if (CheckJsonExists(componentJson, "scale"))
-		transform->Scale = GetVectorFromJson(componentJson, "scale");
+		transform.Scale = GetVectorFromJson(componentJson, "scale");
 	if (CheckJsonExists(componentJson, "angle") && CheckJsonNumber(componentJson, "angle"))
-		transform->EulerAngle = componentJson["angle"];
+		transform.EulerAngle = componentJson["angle"];
+	SetLocalTransform(entity, transform);
+}
+
+void Transform2dManager::CreateComponents(json& componentJson, const std::vector<Entity>& entities)
+{
+	if (entities.empty())
+	{
+		return;
+	}
+	CreateComponent(componentJson, entities.front());
+	const auto transform = GetLocalTransform(entities.front());
+	if (m_SoAStorage)
+	{
+		m_SoA.Reserve(m_SoA.Size() + entities.size());
+	}
+	for (size_t i = 1; i < entities.size(); i++)
+	{
+		AddComponent(entities[i]);
+		SetLocalTransform(entities[i], transform);
+	}
 }
 
 void Transform2dManager::DestroyComponent(Entity entity)
 {
+	DetachFromHierarchy(entity);
 	m_Engine.GetEntityManager()->RemoveComponentType(entity, ComponentType::TRANSFORM2D);
+	RemoveTransform(entity);
+}
+
+void Transform2dManager::RemoveTransform(Entity entity)
+{
+	RemoveComponent(entity);
+	const auto soaIndex = GetSoAIndex(entity);
+	if (soaIndex == INVALID_SOA_INDEX)
+	{
+		return;
+	}
+	const auto lastIndex = m_SoA.Size() - 1;
+	if (soaIndex != lastIndex)
+	{
+		m_SoAIndexes[GetEntityIndex(m_SoA.GetEntity(lastIndex))] = soaIndex;
+	}
+	m_SoA.Remove(soaIndex);
+	m_SoAIndexes[GetEntityIndex(entity)] = INVALID_SOA_INDEX;
+}
+
+Transform2dRef Transform2dManager::GetComponentRef(Entity entity)
+{
+	return Transform2dRef(this, entity);
+}
+
+bool Transform2dManager::HasTransform(Entity entity) const
+{
+	return m_SoAStorage ? GetSoAIndex(entity) != INVALID_SOA_INDEX : m_Components.Contains(entity);
+}
+
+Transform2d Transform2dManager::GetLocalTransform(Entity entity) const
+{
+	if (m_SoAStorage)
+	{
+		const auto soaIndex = GetSoAIndex(entity);
+		return soaIndex != INVALID_SOA_INDEX ? m_SoA.Get(soaIndex) : Transform2d();
+	}
+	const auto* transform = m_Components.Get(entity);
+	return transform != nullptr ? *transform : Transform2d();
+}
+
+void Transform2dManager::SetLocalTransform(Entity entity, const Transform2d& transform)
+{
+	if (m_SoAStorage)
+	{
+		const auto soaIndex = GetSoAIndex(entity);
+		if (soaIndex != INVALID_SOA_INDEX)
+		{
+			m_SoA.Set(soaIndex, transform);
+		}
+	}
+	else if (auto* component = m_Components.Get(entity))
+	{
+		*component = transform;
+	}
+}
+
+Transform2dSoA* Transform2dManager::GetSoA()
+{
+	return m_SoAStorage ? &m_SoA : nullptr;
+}
+
+size_t Transform2dManager::GetSoAIndex(Entity entity) const
+{
+	const auto index = GetEntityIndex(entity);
+	if (entity == INVALID_ENTITY || index >= m_SoAIndexes.size())
+	{
+		return INVALID_SOA_INDEX;
+	}
+	const auto soaIndex = m_SoAIndexes[index];
+	return soaIndex != INVALID_SOA_INDEX && m_SoA.GetEntity(soaIndex) == entity ? soaIndex : INVALID_SOA_INDEX;
 }
 
 
 void Transform2dManager::OnUpdate(float dt) {
 	System::OnUpdate(dt);
-    for(auto& transform : m_Components)
+	m_FrameVersion++;
+	const auto* config = m_Engine.GetConfig();
+	const bool interpolate = config != nullptr && config->interpolateTransforms;
+	if (m_SoAStorage)
+	{
+		//The angles are wrapped four at a time in their array
+		m_SoA.WrapAngles();
+		const size_t minChunkSize = PARALLEL_FOR_MIN_CHUNK_BYTES / sizeof(Transform2d);
+		m_Engine.GetJobSystem().ParallelFor(0, m_SoA.Size(), minChunkSize, [this, interpolate](size_t start, size_t end)
+		{
+			for (auto i = start; i < end; i++)
+			{
+				CheckTransformChange(m_SoA.GetEntity(i), m_SoA.Get(i), interpolate);
+			}
+		});
+	}
+	else
+	{
+		m_Components.ParallelForEach(m_Engine.GetJobSystem(), [this, interpolate](Entity entity, Transform2d& transform)
+		{
+			transform.EulerAngle = WrapAngle(transform.EulerAngle);
+			CheckTransformChange(entity, transform, interpolate);
+		});
+	}
+	UpdateWorldTransforms();
+}
+
+void Transform2dManager::CheckTransformChange(Entity entity, const Transform2d& transform, bool interpolate)
+{
+	const auto index = GetEntityIndex(entity);
+	auto& lastTransform = m_LastTransforms[index];
+	//The interpolated transform keeps moving until the previous fixed update transform catches up
+	const bool interpolating = interpolate && m_PreviousValid[index] && m_PreviousComponents[index] != transform;
+	if (interpolating || lastTransform != transform)
+	{
+		lastTransform = transform;
+		m_ChangeVersions[index] = m_FrameVersion;
+	}
+}
+
+void Transform2dManager::OnDestroy(Entity entity)
+{
+	DetachFromHierarchy(entity);
+	RemoveTransform(entity);
+}
+
+void Transform2dManager::OnBeforeSceneLoad()
+{
+	SingleComponentManager::OnBeforeSceneLoad();
+	m_SoA.Clear();
+	std::fill(m_SoAIndexes.begin(), m_SoAIndexes.end(), INVALID_SOA_INDEX);
+	std::fill(m_Parents.begin(), m_Parents.end(), INVALID_ENTITY);
+	m_Children.clear();
+	m_HierarchyOrder.clear();
+	m_HierarchyDirty = false;
+}
+
+bool Transform2dManager::SetParent(Entity entity, Entity parent)
+{
+	if (entity == INVALID_ENTITY || !HasTransform(entity))
+	{
+		Log::GetInstance()->Error("Trying to set the parent of an entity without transform");
+		return false;
+	}
+	if (parent != INVALID_ENTITY)
+	{
+		if (!HasTransform(parent))
+		{
+			Log::GetInstance()->Error("Trying to set a parent without transform");
+			return false;
+		}
+		for (auto ancestor = parent; ancestor != INVALID_ENTITY; ancestor = m_Parents[GetEntityIndex(ancestor)])
+		{
+			if (ancestor == entity)
+			{
+				Log::GetInstance()->Error("Trying to set a child as the parent of its ancestor");
+				return false;
+			}
+		}
+	}
+	const auto index = GetEntityIndex(entity);
+	auto& currentParent = m_Parents[index];
+	if (currentParent == parent)
+	{
+		return true;
+	}
+	if (currentParent == INVALID_ENTITY)
+	{
+		m_Children.push_back(entity);
+	}
+	else if (parent == INVALID_ENTITY)
 	{
-    	if(transform.EulerAngle > 180.0f)
+		m_Children.erase(std::find(m_Children.begin(), m_Children.end(), entity));
+	}
+	currentParent = parent;
+	//Sprites and shapes read the new world transform
+	m_ChangeVersions[index] = m_FrameVersion + 1;
+	m_HierarchyDirty = true;
+	return true;
+}
+
+Entity Transform2dManager::GetParent(Entity entity) const
+{
+	const auto index = GetEntityIndex(entity);
+	return index < m_Parents.size() ? m_Parents[index] : INVALID_ENTITY;
+}
+
+Transform2d Transform2dManager::GetWorldTransform(Entity entity) const
+{
+	const auto index = GetEntityIndex(entity);
+	if (index < m_Parents.size() && m_Parents[index] != INVALID_ENTITY)
+	{
+		return m_WorldTransforms[index];
+	}
+	return GetLocalTransform(entity);
+}
+
+sf::Transform Transform2dManager::GetWorldMatrix(Entity entity) const
+{
+	const auto index = GetEntityIndex(entity);
+	if (index < m_Parents.size() && m_Parents[index] != INVALID_ENTITY)
+	{
+		return m_WorldMatrices[index];
+	}
+	return HasTransform(entity) ? GetLocalMatrix(GetLocalTransform(entity)) : sf::Transform();
+}
+
+Vec2f Transform2dManager::WorldToLocalPosition(Entity entity, Vec2f worldPosition) const
+{
+	const auto parent = GetParent(entity);
+	if (parent == INVALID_ENTITY)
+	{
+		return worldPosition;
+	}
+	//The cached matrix of the parent is not written while the bodies update their transforms in parallel
+	const auto parentIndex = GetEntityIndex(parent);
+	const auto parentMatrix = m_WorldVersions[parentIndex] != 0U ? m_WorldMatrices[parentIndex] : GetWorldMatrix(parent);
+	return parentMatrix.getInverse().transformPoint(worldPosition);
+}
+
+void Transform2dManager::DetachFromHierarchy(Entity entity)
+{
+	const auto childNmb = m_Children.size();
+	//The children of the entity become roots and keep their local transform
+	m_Children.erase(std::remove_if(m_Children.begin(), m_Children.end(), [this, entity](Entity child)
+	{
+		auto& parent = m_Parents[GetEntityIndex(child)];
+		if (child == entity || parent == entity)
 		{
-    		transform.EulerAngle -= 360.0f;
+			parent = INVALID_ENTITY;
+			return true;
 		}
+		return false;
+	}), m_Children.end());
+	if (m_Children.size() != childNmb)
+	{
+		m_HierarchyDirty = true;
+	}
+}
 
-		if(transform.EulerAngle < -180.0f)
+void Transform2dManager::SortHierarchy()
+{
+	std::vector<std::pair<unsigned, Entity>> depths;
+	depths.reserve(m_Children.size() * 2);
+	for (auto child : m_Children)
+	{
+		unsigned depth = 0;
+		auto root = child;
+		while (m_Parents[GetEntityIndex(root)] != INVALID_ENTITY)
 		{
-			transform.EulerAngle += 360.0f;
+			root = m_Parents[GetEntityIndex(root)];
+			depth++;
 		}
+		depths.emplace_back(depth, child);
+		depths.emplace_back(0U, root);
+	}
+	std::sort(depths.begin(), depths.end());
+	depths.erase(std::unique(depths.begin(), depths.end()), depths.end());
+	m_HierarchyOrder.clear();
+	for (auto& depth : depths)
+	{
+		m_HierarchyOrder.push_back(depth.second);
+	}
+}
+
+void Transform2dManager::UpdateWorldTransforms()
+{
+	//A new hierarchy has no world transform yet, compute all of them once
+	const bool forceUpdate = m_HierarchyDirty;
+	if (m_HierarchyDirty)
+	{
+		SortHierarchy();
+		m_HierarchyDirty = false;
+	}
+	for (auto entity : m_HierarchyOrder)
+	{
+		const auto index = GetEntityIndex(entity);
+		const auto parent = m_Parents[index];
+		const bool parentChanged = parent != INVALID_ENTITY && m_WorldVersions[GetEntityIndex(parent)] == m_FrameVersion;
+		if (!forceUpdate && !parentChanged && m_ChangeVersions[index] != m_FrameVersion)
+		{
+			continue;
+		}
+		const auto transform = GetLocalTransform(entity);
+		const auto localMatrix = GetLocalMatrix(transform);
+		if (parent == INVALID_ENTITY)
+		{
+			m_WorldTransforms[index] = transform;
+			m_WorldMatrices[index] = localMatrix;
+		}
+		else
+		{
+			const auto parentIndex = GetEntityIndex(parent);
+			const auto& parentMatrix = m_WorldMatrices[parentIndex];
+			m_WorldTransforms[index] = CombineTransforms(m_WorldTransforms[parentIndex], parentMatrix, transform);
+			m_WorldMatrices[index] = parentMatrix * localMatrix;
+			m_ChangeVersions[index] = m_FrameVersion;
+		}
+		m_WorldVersions[index] = m_FrameVersion;
+	}
+}
+
+void Transform2dManager::OnResize(size_t newSize)
+{
+	SingleComponentManager::OnResize(newSize);
+	//From the last array index, as the removal moves the last transform
+	for (auto soaIndex = m_SoA.Size(); soaIndex > 0; soaIndex--)
+	{
+		const auto entity = m_SoA.GetEntity(soaIndex - 1);
+		if (GetEntityIndex(entity) >= newSize)
+		{
+			RemoveTransform(entity);
+		}
+	}
+	ResizeTransformArrays(newSize);
+}
+
+void Transform2dManager::ResizeTransformArrays(size_t newSize)
+{
+	m_PreviousComponents.resize(newSize);
+	m_PreviousValid.resize(newSize, false);
+	m_LastTransforms.resize(newSize);
+	m_ChangeVersions.resize(newSize, 0U);
+	if (newSize < m_Parents.size())
+	{
+		//Detach the children and parents removed by the resize
+		m_Children.erase(std::remove_if(m_Children.begin(), m_Children.end(), [this, newSize](Entity child)
+		{
+			auto& parent = m_Parents[GetEntityIndex(child)];
+			if (GetEntityIndex(child) >= newSize || GetEntityIndex(parent) >= newSize)
+			{
+				parent = INVALID_ENTITY;
+				return true;
+			}
+			return false;
+		}), m_Children.end());
+		m_HierarchyDirty = true;
+	}
+	m_Parents.resize(newSize, INVALID_ENTITY);
+	m_WorldTransforms.resize(newSize);
+	m_WorldMatrices.resize(newSize);
+	m_WorldVersions.resize(newSize, 0U);
+	m_SoAIndexes.resize(newSize, INVALID_SOA_INDEX);
+}
+
+unsigned Transform2dManager::GetFrameVersion() const
+{
+	return m_FrameVersion;
+}
+
+unsigned Transform2dManager::GetChangeVersion(Entity entity) const
+{
+	const auto index = GetEntityIndex(entity);
+	return index < m_ChangeVersions.size() ? m_ChangeVersions[index] : 0U;
+}
+
+void Transform2dManager::SaveSnapshot(Snapshot& snapshot)
+{
+	m_SnapshotEntities.clear();
+	m_SnapshotTransforms.clear();
+	ForEachTransform([this](Entity entity, const Transform2d& transform)
+	{
+		m_SnapshotEntities.push_back(entity);
+		m_SnapshotTransforms.push_back(transform);
+	});
+	const std::vector<unsigned char> previousValid(m_PreviousValid.begin(), m_PreviousValid.end());
+	snapshot.WriteArray(m_SnapshotEntities.data(), m_SnapshotEntities.size());
+	snapshot.WriteArray(m_SnapshotTransforms.data(), m_SnapshotTransforms.size());
+	snapshot.WriteArray(m_PreviousComponents.data(), m_PreviousComponents.size());
+	snapshot.WriteArray(previousValid.data(), previousValid.size());
+}
+
+void Transform2dManager::RestoreSnapshot(Snapshot& snapshot)
+{
+	size_t transformNmb = 0;
+	size_t previousNmb = 0;
+	size_t previousValidNmb = 0;
+	const auto* entities = snapshot.ReadArray<Entity>(transformNmb);
+	const auto* transforms = snapshot.ReadArray<Transform2d>(transformNmb);
+	const auto* previousTransforms = snapshot.ReadArray<Transform2d>(previousNmb);
+	const auto* previousValid = snapshot.ReadArray<unsigned char>(previousValidNmb);
+	for (size_t i = 0; i < transformNmb; i++)
+	{
+		SetLocalTransform(entities[i], transforms[i]);
+	}
+	for (size_t index = 0; index < previousNmb && index < m_PreviousComponents.size(); index++)
+	{
+		m_PreviousComponents[index] = previousTransforms[index];
+		m_PreviousValid[index] = index < previousValidNmb && previousValid[index] != 0;
+	}
+	//Sprites, shapes and children read all the restored transforms
+	std::fill(m_ChangeVersions.begin(), m_ChangeVersions.end(), m_FrameVersion + 1);
+	m_HierarchyDirty = !m_Children.empty();
+}
+
+void Transform2dManager::StorePreviousTransforms()
+{
+	ForEachTransform([this](Entity entity, const Transform2d& transform)
+	{
+		const auto index = GetEntityIndex(entity);
+		if (index >= m_PreviousComponents.size())
+		{
+			ResizeTransformArrays(index + 1);
+		}
+		m_PreviousComponents[index] = transform;
+		m_PreviousValid[index] = true;
+	});
+}
+
+Transform2d Transform2dManager::GetInterpolatedTransform(Entity entity, float alpha) const
+{
+	if (!HasTransform(entity))
+	{
+		return Transform2d();
+	}
+	const auto current = GetLocalTransform(entity);
+	const auto index = GetEntityIndex(entity);
+	if (index >= m_PreviousValid.size() || !m_PreviousValid[index])
+	{
+		return current;
+	}
+	const auto& previous = m_PreviousComponents[index];
+	float deltaAngle = current.EulerAngle - previous.EulerAngle;
+	//Blend through the shortest arc as the angles are wrapped between -180 and 180
+	if (deltaAngle > 180.0f)
+	{
+		deltaAngle -= 360.0f;
+	}
+	if (deltaAngle < -180.0f)
+	{
+		deltaAngle += 360.0f;
+	}
+	Transform2d transform;
+	transform.Position = previous.Position + (current.Position - previous.Position) * alpha;
+	transform.Scale = previous.Scale + (current.Scale - previous.Scale) * alpha;
+	transform.EulerAngle = previous.EulerAngle + deltaAngle * alpha;
+	return transform;
+}
+
+Transform2d Transform2dManager::GetInterpolatedWorldTransform(Entity entity, float alpha) const
+{
+	//Each ancestor is blended on its own, then the chain is combined like in UpdateWorldTransforms
+	auto worldTransform = GetInterpolatedTransform(entity, alpha);
+	for (auto parent = GetParent(entity); parent != INVALID_ENTITY; parent = GetParent(parent))
+	{
+		const auto parentTransform = GetInterpolatedTransform(parent, alpha);
+		worldTransform = CombineTransforms(parentTransform, GetLocalMatrix(parentTransform), worldTransform);
 	}
+	return worldTransform;
 }
 
 }
@@ -0,0 +1,193 @@
+/*
+MIT License
+
+Copyright (c) 2017 SAE Institute Switzerland AG
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <engine/transform2d_soa.h>
+#include <engine/transform2d.h>
+
+#if defined(__SSE__) || defined(_M_X64)
+#include <xmmintrin.h>
+#define SFGE_TRANSFORM_SSE
+#endif
+
+namespace sfge
+{
+
+void WrapAngles(float* angles, size_t count)
+{
+	size_t i = 0;
+#ifdef SFGE_TRANSFORM_SSE
+	const __m128 maxAngle = _mm_set1_ps(180.0f);
+	const __m128 minAngle = _mm_set1_ps(-180.0f);
+	const __m128 turn = _mm_set1_ps(360.0f);
+	for (; i + 4 <= count; i += 4)
+	{
+		__m128 angle = _mm_loadu_ps(angles + i);
+		angle = _mm_sub_ps(angle, _mm_and_ps(_mm_cmpgt_ps(angle, maxAngle), turn));
+		angle = _mm_add_ps(angle, _mm_and_ps(_mm_cmplt_ps(angle, minAngle), turn));
+		_mm_storeu_ps(angles + i, angle);
+	}
+#endif
+	for (; i < count; i++)
+	{
+		angles[i] = WrapAngle(angles[i]);
+	}
+}
+
+void TranslatePositions(float* positionsX, float* positionsY, size_t count, Vec2f delta)
+{
+	size_t i = 0;
+#ifdef SFGE_TRANSFORM_SSE
+	const __m128 deltaX = _mm_set1_ps(delta.x);
+	const __m128 deltaY = _mm_set1_ps(delta.y);
+	for (; i + 4 <= count; i += 4)
+	{
+		_mm_storeu_ps(positionsX + i, _mm_add_ps(_mm_loadu_ps(positionsX + i), deltaX));
+		_mm_storeu_ps(positionsY + i, _mm_add_ps(_mm_loadu_ps(positionsY + i), deltaY));
+	}
+#endif
+	for (; i < count; i++)
+	{
+		positionsX[i] += delta.x;
+		positionsY[i] += delta.y;
+	}
+}
+
+void IntegratePositions(float* positionsX, float* positionsY,
+	const float* velocitiesX, const float* velocitiesY, size_t count, float dt)
+{
+	size_t i = 0;
+#ifdef SFGE_TRANSFORM_SSE
+	const __m128 deltaTime = _mm_set1_ps(dt);
+	for (; i + 4 <= count; i += 4)
+	{
+		const __m128 moveX = _mm_mul_ps(_mm_loadu_ps(velocitiesX + i), deltaTime);
+		const __m128 moveY = _mm_mul_ps(_mm_loadu_ps(velocitiesY + i), deltaTime);
+		_mm_storeu_ps(positionsX + i, _mm_add_ps(_mm_loadu_ps(positionsX + i), moveX));
+		_mm_storeu_ps(positionsY + i, _mm_add_ps(_mm_loadu_ps(positionsY + i), moveY));
+	}
+#endif
+	for (; i < count; i++)
+	{
+		positionsX[i] += velocitiesX[i] * dt;
+		positionsY[i] += velocitiesY[i] * dt;
+	}
+}
+
+size_t Transform2dSoA::Add(Entity entity, const Transform2d& transform)
+{
+	const auto index = m_Entities.size();
+	m_Entities.push_back(entity);
+	positionsX.push_back(transform.Position.x);
+	positionsY.push_back(transform.Position.y);
+	scalesX.push_back(transform.Scale.x);
+	scalesY.push_back(transform.Scale.y);
+	angles.push_back(transform.EulerAngle);
+	return index;
+}
+
+void Transform2dSoA::Remove(size_t index)
+{
+	const auto lastIndex = m_Entities.size() - 1;
+	if (index != lastIndex)
+	{
+		m_Entities[index] = m_Entities[lastIndex];
+		Set(index, Get(lastIndex));
+	}
+	m_Entities.pop_back();
+	positionsX.pop_back();
+	positionsY.pop_back();
+	scalesX.pop_back();
+	scalesY.pop_back();
+	angles.pop_back();
+}
+
+void Transform2dSoA::Clear()
+{
+	m_Entities.clear();
+	positionsX.clear();
+	positionsY.clear();
+	scalesX.clear();
+	scalesY.clear();
+	angles.clear();
+}
+
+void Transform2dSoA::Reserve(size_t capacity)
+{
+	m_Entities.reserve(capacity);
+	positionsX.reserve(capacity);
+	positionsY.reserve(capacity);
+	scalesX.reserve(capacity);
+	scalesY.reserve(capacity);
+	angles.reserve(capacity);
+}
+
+size_t Transform2dSoA::Size() const
+{
+	return m_Entities.size();
+}
+
+Transform2d Transform2dSoA::Get(size_t index) const
+{
+	Transform2d transform;
+	transform.Position = Vec2f(positionsX[index], positionsY[index]);
+	transform.Scale = Vec2f(scalesX[index], scalesY[index]);
+	transform.EulerAngle = angles[index];
+	return transform;
+}
+
+void Transform2dSoA::Set(size_t index, const Transform2d& transform)
+{
+	positionsX[index] = transform.Position.x;
+	positionsY[index] = transform.Position.y;
+	scalesX[index] = transform.Scale.x;
+	scalesY[index] = transform.Scale.y;
+	angles[index] = transform.EulerAngle;
+}
+
+Entity Transform2dSoA::GetEntity(size_t index) const
+{
+	return m_Entities[index];
+}
+
+const std::vector<Entity>& Transform2dSoA::GetEntities() const
+{
+	return m_Entities;
+}
+
+void Transform2dSoA::WrapAngles()
+{
+	sfge::WrapAngles(angles.data(), angles.size());
+}
+
+void Transform2dSoA::Translate(Vec2f delta)
+{
+	TranslatePositions(positionsX.data(), positionsY.data(), Size(), delta);
+}
+
+void Transform2dSoA::Integrate(const float* velocitiesX, const float* velocitiesY, float dt)
+{
+	IntegratePositions(positionsX.data(), positionsY.data(), velocitiesX, velocitiesY, Size(), dt);
+}
+
+}
@@ -70,19 +70,23 @@ void Graphics2dManager::OnEngineInit()
 	m_ShapeManager.OnEngineInit();
 	m_SpriteManager.OnEngineInit();
 
+	if (const auto configPtr = m_Engine.GetConfig())
+	{
+		m_Pipelined = !m_Windowless && configPtr->pipelinedRendering;
+	}
+	if (m_Pipelined)
+	{
+		Log::GetInstance()->Error("[Warning] pipelinedRendering disables the python OnDraw and the debug drawing");
+		m_RenderPipeline.Start(m_Window.get());
+	}
 }
 
 void Graphics2dManager::OnUpdate(float dt)
 {
-	if (!m_Windowless)
+	if (!m_Windowless && !m_Pipelined)
 	{
 		rmt_ScopedCPUSample(Graphics2dUpdate,0)
 		m_Window->clear();
-
-		m_SpriteManager.OnUpdate(dt);
-		m_ShapeManager.OnUpdate(dt);
-
-		
 	}
 }
 
@@ -106,8 +110,39 @@ void Graphics2dManager::Display()
 	}
 }
 
+void Graphics2dManager::PublishSnapshot()
+{
+	rmt_ScopedCPUSample(Graphics2dPublishSnapshot,0)
+	if (m_Pipelined)
+	{
+		auto& snapshot = m_RenderPipeline.GetWriteSnapshot();
+		m_SpriteManager.FillSnapshot(snapshot);
+		m_ShapeManager.FillSnapshot(snapshot);
+		m_RenderPipeline.Publish();
+	}
+}
+
+bool Graphics2dManager::IsPipelined() const
+{
+	return m_Pipelined;
+}
+
+void Graphics2dManager::CloseWindow()
+{
+	m_RenderPipeline.Stop();
+	if (m_Window != nullptr)
+	{
+		m_Window->close();
+	}
+}
+
 void Graphics2dManager::DrawLine(Vec2f from, Vec2f to, sf::Color color)
 {
+	//The window belongs to the render thread in pipelined mode
+	if (m_Windowless || m_Pipelined)
+	{
+		return;
+	}
 	sf::Vertex vertices[2] =
 	{
 	    sf::Vertex(from, color),
@@ -149,6 +184,8 @@ void Graphics2dManager::CheckVersion() const
 
 void Graphics2dManager::Destroy()
 {
+	m_RenderPipeline.Stop();
+	m_Pipelined = false;
 	OnBeforeSceneLoad();
 	OnAfterSceneLoad();
 
@@ -157,6 +194,8 @@ void Graphics2dManager::Destroy()
 
 void Graphics2dManager::OnBeforeSceneLoad()
 {
+	//The render thread may still draw sprites using the textures about to be released
+	m_RenderPipeline.WaitIdle();
 	m_TextureManager.OnBeforeSceneLoad();
 	m_SpriteManager.OnBeforeSceneLoad();
 }
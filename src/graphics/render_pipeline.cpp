@@ -0,0 +1,151 @@
+/*
+MIT License
+
+Copyright (c) 2017 SAE Institute Switzerland AG
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <graphics/render_pipeline.h>
+#include <Remotery.h>
+
+namespace sfge
+{
+
+void RenderSnapshot::Clear()
+{
+	sprites.clear();
+	shapeVertices.clear();
+}
+
+RenderPipeline::~RenderPipeline()
+{
+	Stop();
+}
+
+void RenderPipeline::Start(sf::RenderWindow* window)
+{
+	if (m_Running || window == nullptr)
+	{
+		return;
+	}
+	m_Window = window;
+	m_Window->setActive(false);
+	m_Running = true;
+	m_Thread = std::thread(&RenderPipeline::RenderLoop, this);
+}
+
+void RenderPipeline::Stop()
+{
+	if (!m_Thread.joinable())
+	{
+		return;
+	}
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		m_Running = false;
+	}
+	m_Condition.notify_all();
+	m_Thread.join();
+	m_Window->setActive(true);
+	m_Window = nullptr;
+}
+
+bool RenderPipeline::IsRunning() const
+{
+	return m_Running;
+}
+
+RenderSnapshot& RenderPipeline::GetWriteSnapshot()
+{
+	return m_Snapshots[m_WriteIndex];
+}
+
+void RenderPipeline::Publish()
+{
+	rmt_ScopedCPUSample(RenderPipelinePublish, 0);
+	{
+		std::unique_lock<std::mutex> lock(m_Mutex);
+		m_Condition.wait(lock, [this]
+		{
+			return !m_HasNewSnapshot || !m_Running;
+		});
+		std::swap(m_WriteIndex, m_ReadyIndex);
+		m_HasNewSnapshot = true;
+	}
+	m_Condition.notify_all();
+	m_Snapshots[m_WriteIndex].Clear();
+}
+
+void RenderPipeline::WaitIdle()
+{
+	std::unique_lock<std::mutex> lock(m_Mutex);
+	m_Condition.wait(lock, [this]
+	{
+		return (!m_HasNewSnapshot && !m_IsDrawing) || !m_Running;
+	});
+}
+
+void RenderPipeline::RenderLoop()
+{
+	m_Window->setActive(true);
+	while (true)
+	{
+		{
+			std::unique_lock<std::mutex> lock(m_Mutex);
+			m_Condition.wait(lock, [this]
+			{
+				return m_HasNewSnapshot || !m_Running;
+			});
+			if (!m_HasNewSnapshot)
+			{
+				break;
+			}
+			std::swap(m_ReadIndex, m_ReadyIndex);
+			m_HasNewSnapshot = false;
+			m_IsDrawing = true;
+		}
+		//The simulation can publish the next snapshot while this one is drawn
+		m_Condition.notify_all();
+		Draw(m_Snapshots[m_ReadIndex]);
+		{
+			std::lock_guard<std::mutex> lock(m_Mutex);
+			m_IsDrawing = false;
+		}
+		m_Condition.notify_all();
+	}
+	m_Window->setActive(false);
+}
+
+void RenderPipeline::Draw(const RenderSnapshot& snapshot) const
+{
+	rmt_ScopedCPUSample(RenderPipelineDraw, 0);
+	m_Window->clear();
+	for (const auto& sprite : snapshot.sprites)
+	{
+		m_Window->draw(sprite);
+	}
+	if (!snapshot.shapeVertices.empty())
+	{
+		m_Window->draw(snapshot.shapeVertices.data(), snapshot.shapeVertices.size(), sf::Triangles);
+	}
+	m_Window->display();
+}
+
+}
@@ -28,6 +28,7 @@ SOFTWARE.
 #include <utility/log.h>
 #include <engine/transform2d.h>
 #include <engine/engine.h>
+#include <engine/config.h>
 #include <imgui.h>
 #include <imgui-SFML.h>
 
@@ -72,9 +73,41 @@ void Shape::Update() const
 		m_Shape->setScale(transform.Scale);
 	}
 }
+void Shape::AppendTriangles(std::vector<sf::Vertex>& vertices) const
+{
+	if (m_Shape == nullptr)
+	{
+		return;
+	}
+	const auto pointNmb = m_Shape->getPointCount();
+	if (pointNmb < 3)
+	{
+		return;
+	}
+	const auto& shapeTransform = m_Shape->getTransform();
+	const auto color = m_Shape->getFillColor();
+	const auto center = shapeTransform.transformPoint(m_Shape->getPoint(0));
+	auto previous = shapeTransform.transformPoint(m_Shape->getPoint(1));
+	//Same fan as sf::Shape, split in triangles to batch all the shapes in one draw call
+	for (auto i = 2u; i < pointNmb; i++)
+	{
+		const auto current = shapeTransform.transformPoint(m_Shape->getPoint(i));
+		vertices.emplace_back(center, color);
+		vertices.emplace_back(previous, color);
+		vertices.emplace_back(current, color);
+		previous = current;
+	}
+}
+
 void Shape::SetShape (std::unique_ptr<sf::Shape> shape)
 {
 	m_Shape = std::move(shape);
+	transformVersion = 0;
+}
+void Shape::SetOffset(sf::Vector2f offset)
+{
+	Offsetable::SetOffset(offset);
+	transformVersion = 0;
 }
 sf::Shape *Shape::GetShape ()
 {
@@ -127,13 +160,20 @@ void ShapeManager::DrawShapes(sf::RenderWindow &window)
 {
 
 	rmt_ScopedCPUSample(ShapeDraw,0)
-	for(auto i = 0u; i < m_Components.size(); i++)
+	//In entity order, the entities created later are drawn on top
+	m_Components.ForEach([&window](Entity, Shape& shape)
 	{
-		if(m_EntityManager->HasComponent(i + 1, ComponentType::SHAPE2D))
-		{
-			m_Components[i].Draw(window);
-		}
-	}
+		shape.Draw(window);
+	});
+}
+
+void ShapeManager::FillSnapshot(RenderSnapshot& snapshot)
+{
+	rmt_ScopedCPUSample(ShapeFillSnapshot,0)
+	m_Components.ForEach([&snapshot](Entity, Shape& shape)
+	{
+		shape.AppendTriangles(snapshot.shapeVertices);
+	});
 }
 
 void ShapeManager::OnUpdate(const float dt)
@@ -142,37 +182,49 @@ void ShapeManager::OnUpdate(const float dt)
 	(void)dt;
 	rmt_ScopedCPUSample(ShapeUpdate, 0);
 	auto* transformManager = m_Engine.GetTransform2dManager();
-	for (auto i = 0u; i < m_Components.size(); i++)
+	const auto* config = m_Engine.GetConfig();
+	const bool interpolate = config != nullptr && config->interpolateTransforms;
+	const float alpha = m_Engine.GetFixedUpdateAlpha();
+	m_Components.ParallelForEach(m_Engine.GetJobSystem(), [this, transformManager, interpolate, alpha](Entity entity, Shape& component)
 	{
-		if (m_EntityManager->HasComponent(i + 1, ComponentType::SHAPE2D))
+		if(m_EntityManager->HasComponent<Transform2d>(entity))
 		{
-			if(m_EntityManager->HasComponent(i+1, ComponentType::TRANSFORM2D))
+			//Static shapes keep the transform they were given
+			const auto changeVersion = transformManager->GetChangeVersion(entity);
+			if (changeVersion == component.transformVersion)
 			{
-				m_Components[i].transform = transformManager->GetComponentRef(i + 1);
+				return;
 			}
-			m_Components[i].Update();
+			component.transformVersion = changeVersion;
+			//Children are placed on the interpolated transforms of their parents, like the roots
+			component.transform = interpolate ?
+				transformManager->GetInterpolatedWorldTransform(entity, alpha) :
+				transformManager->GetWorldTransform(entity);
 		}
-	}
-	
+		component.Update();
+	});
 }
 
 void ShapeManager::OnBeforeSceneLoad()
 {
-	m_Components.clear ();
-	m_Components.resize (INIT_ENTITY_NMB);
-
+	SingleComponentManager::OnBeforeSceneLoad();
 }
 
 
 
 Shape *ShapeManager::AddComponent (Entity entity)
 {
-	auto shapePtr = GetComponentPtr (entity);
-	auto& shapeInfo = GetComponentInfo(entity);
-	shapeInfo.SetEntity(entity);
-	shapeInfo.shapeManager = this;
+	auto* shapePtr = GetOrCreateComponent(entity);
+	if (shapePtr == nullptr)
+	{
+		return nullptr;
+	}
+	if (auto* shapeInfo = GetComponentInfo(entity))
+	{
+		shapeInfo->SetEntity(entity);
+		shapeInfo->shapeManager = this;
+	}
 
-	m_Engine.GetEntityManager()->AddComponentType(entity, ComponentType::SHAPE2D);
 	return shapePtr;
 }
 
@@ -185,12 +237,18 @@ void ShapeManager::CreateComponent(json& componentJson, Entity entity)
 		offset = GetVectorFromJson(componentJson, "offset");
 	}
 
-	auto& shape = m_Components[entity-1];
-	shape.SetOffset(offset);
+	auto* shape = GetOrCreateComponent(entity);
+	if (shape == nullptr)
+	{
+		return;
+	}
+	shape->SetOffset(offset);
 
-	auto& shapeInfo = m_ComponentsInfo[entity - 1];
-	shapeInfo.shapeManager = this;
-	shapeInfo.SetEntity(entity);
+	if (auto* shapeInfo = GetComponentInfo(entity))
+	{
+		shapeInfo->shapeManager = this;
+		shapeInfo->SetEntity(entity);
+	}
 
 	if (CheckJsonNumber(componentJson, "shape_type"))
 	{
@@ -209,8 +267,8 @@ void ShapeManager::CreateComponent(json& componentJson, Entity entity)
 			auto circleShape = std::make_unique <sf::CircleShape>();
 			circleShape->setRadius (radius);
 			circleShape->setOrigin (radius, radius);
-			shape.SetShape (std::move(circleShape));
-			shape.Update ();
+			shape->SetShape (std::move(circleShape));
+			shape->Update ();
 		}
 			break;
 		case ShapeType::RECTANGLE:
@@ -228,8 +286,8 @@ void ShapeManager::CreateComponent(json& componentJson, Entity entity)
 			auto rect = std::make_unique<sf::RectangleShape>();
 			rect->setSize (size);
 			rect->setOrigin (size.x/2.0f, size.y/2.0f);
-            shape.SetShape (std::move (rect));
-            shape.Update ();
+            shape->SetShape (std::move (rect));
+            shape->Update ();
 			
 		}
 			break;
@@ -250,13 +308,13 @@ void ShapeManager::CreateComponent(json& componentJson, Entity entity)
 
 void ShapeManager::DestroyComponent(Entity entity)
 {
-	(void) entity;
+	m_EntityManager->RemoveComponentType(entity, ComponentType::SHAPE2D);
+	RemoveComponent(entity);
 }
 
 void ShapeManager::OnResize(size_t new_size)
 {
-	m_Components.resize(new_size);
-	m_ComponentsInfo.resize(new_size);
+	SingleComponentManager::OnResize(new_size);
 }
 
 }
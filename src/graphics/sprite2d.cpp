@@ -57,6 +57,12 @@ void Sprite::SetTexture(sf::Texture* newTexture)
 }
 
 
+void Sprite::SetOffset(sf::Vector2f offset)
+{
+	Offsetable::SetOffset(offset);
+	transformVersion = 0;
+}
+
 void Sprite::Init()
 {
 }
@@ -98,14 +104,18 @@ void SpriteManager::OnEngineInit()
 
 Sprite* SpriteManager::AddComponent(Entity entity)
 {
-	auto& sprite = GetComponentRef(entity);
-	auto& spriteInfo = GetComponentInfo(entity);
+	auto* sprite = GetOrCreateComponent(entity);
+	if (sprite == nullptr)
+	{
+		return nullptr;
+	}
+	//Creates the info shown by the inspector
+	GetComponentInfo(entity);
 
 	//sprite.SetTransform(m_Transform2dManager->GetComponentPtr(entity));
 	//spriteInfo.sprite = &sprite;
 
-	m_EntityManager->AddComponentType(entity, ComponentType::SPRITE2D);
-	return &sprite;
+	return sprite;
 }
 
 
@@ -115,17 +125,27 @@ void SpriteManager::OnUpdate(float dt)
 
 	rmt_ScopedCPUSample(SpriteUpdate, 0);
 	auto* transformManager = m_Engine.GetTransform2dManager();
-	for(auto i = 0u; i < m_Components.size();i++)
+	const auto* config = m_Engine.GetConfig();
+	const bool interpolate = config != nullptr && config->interpolateTransforms;
+	const float alpha = m_Engine.GetFixedUpdateAlpha();
+	m_Components.ParallelForEach(m_Engine.GetJobSystem(), [this, transformManager, interpolate, alpha](Entity entity, Sprite& component)
 	{
-		if(m_EntityManager->HasComponent(i+1, ComponentType::SPRITE2D))
+		if(m_EntityManager->HasComponent<Transform2d>(entity))
 		{
-			if(m_EntityManager->HasComponent(i+1, ComponentType::TRANSFORM2D))
+			//Static sprites keep the transform they were given
+			const auto changeVersion = transformManager->GetChangeVersion(entity);
+			if (changeVersion == component.transformVersion)
 			{
-				m_Components[i].transform = transformManager->GetComponentRef(i + 1);
+				return;
 			}
-			m_Components[i].Update();
+			component.transformVersion = changeVersion;
+			//Children are placed on the interpolated transforms of their parents, like the roots
+			component.transform = interpolate ?
+				transformManager->GetInterpolatedWorldTransform(entity, alpha) :
+				transformManager->GetWorldTransform(entity);
 		}
-	}
+		component.Update();
+	});
 }
 
 
@@ -133,16 +153,26 @@ void SpriteManager::DrawSprites(sf::RenderWindow &window)
 {
 
 	rmt_ScopedCPUSample(SpriteDraw,0)
-	for (auto i = 0u; i < m_Components.size();i++)
+	//In entity order, the entities created later are drawn on top
+	m_Components.ForEach([&window](Entity, Sprite& sprite)
 	{
-		if(m_EntityManager->HasComponent(i + 1, ComponentType::SPRITE2D))
-			m_Components[i].Draw(window);
-	}
-	
+		sprite.Draw(window);
+	});
+
+}
+
+void SpriteManager::FillSnapshot(RenderSnapshot& snapshot)
+{
+	rmt_ScopedCPUSample(SpriteFillSnapshot,0)
+	m_Components.ForEach([&snapshot](Entity, Sprite& sprite)
+	{
+		snapshot.sprites.push_back(sprite.sprite);
+	});
 }
 
 void SpriteManager::OnBeforeSceneLoad()
 {
+	SingleComponentManager::OnBeforeSceneLoad();
 }
 
 void SpriteManager::OnAfterSceneLoad()
@@ -152,12 +182,19 @@ void SpriteManager::OnAfterSceneLoad()
 
 void SpriteManager::CreateComponent(json& componentJson, Entity entity)
 {
-	auto & newSprite = m_Components[entity - 1];
-	auto & newSpriteInfo = m_ComponentsInfo[entity - 1];
+	auto* newSprite = GetOrCreateComponent(entity);
+	if (newSprite == nullptr)
+	{
+		return;
+	}
+	auto* newSpriteInfo = GetComponentInfo(entity);
 	if (CheckJsonParameter(componentJson, "path", json::value_t::string))
 	{
 		std::string path = componentJson["path"].get<std::string>();
-		newSpriteInfo.texturePath = path;
+		if (newSpriteInfo != nullptr)
+		{
+			newSpriteInfo->texturePath = path;
+		}
 		sf::Texture* texture = nullptr;
 		if (FileExists(path))
 		{
@@ -171,9 +208,12 @@ void SpriteManager::CreateComponent(json& componentJson, Entity entity)
 					sfge::Log::GetInstance()->Msg(oss.str());
 				}*/
 				texture = textureManager->GetTexture(textureId);
-				newSprite.SetTexture(texture);
+				newSprite->SetTexture(texture);
 				//newSprite.SetTransform(m_Transform2dManager->GetComponentPtr(entity));
-				newSpriteInfo.textureId = textureId;
+				if (newSpriteInfo != nullptr)
+				{
+					newSpriteInfo->textureId = textureId;
+				}
 			}
 			else
 			{
@@ -195,19 +235,52 @@ void SpriteManager::CreateComponent(json& componentJson, Entity entity)
 	}
 	if (CheckJsonParameter(componentJson, "layer", json::value_t::number_integer))
 	{
-		newSprite.SetLayer(componentJson["layer"]);
+		newSprite->SetLayer(componentJson["layer"]);
 	}
 
 }
 
+void SpriteManager::CreateComponents(json& componentJson, const std::vector<Entity>& entities)
+{
+	if (entities.empty())
+	{
+		return;
+	}
+	CreateComponent(componentJson, entities.front());
+	const auto* firstSprite = GetComponentPtr(entities.front());
+	if (firstSprite == nullptr)
+	{
+		return;
+	}
+	//The copies share the texture of the first sprite
+	const auto sprite = *firstSprite;
+	const auto* spriteInfo = GetComponentInfo(entities.front());
+	for (size_t i = 1; i < entities.size(); i++)
+	{
+		auto* newSprite = GetOrCreateComponent(entities[i]);
+		if (newSprite == nullptr)
+		{
+			continue;
+		}
+		*newSprite = sprite;
+		newSprite->transformVersion = 0;
+		auto* newSpriteInfo = GetComponentInfo(entities[i]);
+		if (spriteInfo != nullptr && newSpriteInfo != nullptr)
+		{
+			*newSpriteInfo = *spriteInfo;
+			newSpriteInfo->SetEntity(entities[i]);
+		}
+	}
+}
+
 void SpriteManager::DestroyComponent(Entity entity)
 {
-	(void) entity;
+	m_EntityManager->RemoveComponentType(entity, ComponentType::SPRITE2D);
+	RemoveComponent(entity);
 }
 
 void SpriteManager::OnResize(size_t new_size)
 {
-	m_Components.resize(new_size);
-	m_ComponentsInfo.resize(new_size);
+	SingleComponentManager::OnResize(new_size);
 }
 }
@@ -29,6 +29,8 @@ SOFTWARE.
 #include <imgui.h>
 #include <imgui-SFML.h>
 #include <engine/engine.h>
+#include <engine/snapshot.h>
+#include <engine/memory.h>
 namespace sfge
 {
 Body2d::Body2d() : Offsetable(sf::Vector2f())
@@ -87,8 +89,8 @@ b2Body * Body2d::GetBody() const
 
 void editor::Body2dInfo::DrawOnInspector()
 {
-	const auto& body = bodyManager->GetComponentRef(m_Entity);
-	const auto* b2Body = body.GetBody();
+	const auto* body = bodyManager->GetComponentPtr(m_Entity);
+	const auto* b2Body = body != nullptr ? body->GetBody() : nullptr;
 	ImGui::Separator();
 	ImGui::Text("Body2d");
 	if(b2Body != nullptr)
@@ -114,8 +116,9 @@ void editor::Body2dInfo::DrawOnInspector()
 		if (ImGui::IsItemHovered())
 		{
 			auto& velocities = m_Velocities;
-			std::vector<float> xValues(velocities.size());
-			std::vector<float> yValues(velocities.size());
+			StlAllocator<float> frameAllocator(bodyManager->GetFrameAllocator());
+			std::vector<float, StlAllocator<float>> xValues(velocities.size(), 0.0f, frameAllocator);
+			std::vector<float, StlAllocator<float>> yValues(velocities.size(), 0.0f, frameAllocator);
 			for (auto vIndex = 0u; vIndex < velocities.size(); vIndex++)
 			{
 				xValues[vIndex] = velocities[vIndex].x;
@@ -155,17 +158,84 @@ void Body2dManager::OnEngineInit()
 
 void Body2dManager::OnFixedUpdate()
 {
-	for (auto i = 0u; i < m_Components.size(); i++)
+	if (m_Components.IsArchetypeStorage())
 	{
-		const Entity entity = i + 1;
-		if (m_EntityManager->HasComponent(entity, ComponentType::BODY2D) &&
-			m_EntityManager->HasComponent(entity, ComponentType::TRANSFORM2D))
-		{
-			auto & transform = m_Transform2dManager->GetComponentRef(entity);
-			auto & body2d = GetComponentRef(entity);
-			m_ComponentsInfo[i].AddVelocity(body2d.GetLinearVelocity());
-			transform.Position = meter2pixel(body2d.GetBody()->GetPosition()) - static_cast<sf::Vector2f>(body2d.GetOffset());
+		//Bodies and transforms of the same entity are in the same chunk row, read both columns linearly
+		constexpr int bodyIndex = ComponentTraits<Body2d>::index;
+		constexpr int transformIndex = ComponentTraits<Transform2d>::index;
+		constexpr EntityMask mask = ComponentTraits<Body2d>::mask | ComponentTraits<Transform2d>::mask;
+		m_EntityManager->GetArchetypeStorage()->ParallelForEachChunk(m_Engine.GetJobSystem(), mask,
+			[this](const ArchetypeChunkView& chunk)
+		{
+			auto* bodies = chunk.GetColumn<Body2d>(bodyIndex);
+			auto* transforms = chunk.GetColumn<Transform2d>(transformIndex);
+			for (size_t i = 0; i < chunk.count; i++)
+			{
+				auto* body = bodies[i].GetBody();
+				if (body == nullptr)
+				{
+					continue;
+				}
+				auto* bodyInfo = m_StoreComponentsInfo ? m_ComponentsInfo.Get(chunk.entities[i]) : nullptr;
+				if (bodyInfo != nullptr)
+				{
+					bodyInfo->AddVelocity(bodies[i].GetLinearVelocity());
+				}
+				transforms[i].Position = m_Transform2dManager->WorldToLocalPosition(chunk.entities[i],
+					meter2pixel(body->GetPosition()) - static_cast<sf::Vector2f>(bodies[i].GetOffset()));
+			}
+		});
+		return;
+	}
+	m_Components.ParallelForEach(m_Engine.GetJobSystem(), [this](Entity entity, Body2d& body2d)
+	{
+		if (body2d.GetBody() != nullptr && m_EntityManager->HasComponent<Transform2d>(entity))
+		{
+			auto transform = m_Transform2dManager->GetComponentRef(entity);
+			//The velocity history is only drawn by the editor
+			auto* bodyInfo = m_StoreComponentsInfo ? m_ComponentsInfo.Get(entity) : nullptr;
+			if (bodyInfo != nullptr)
+			{
+				bodyInfo->AddVelocity(body2d.GetLinearVelocity());
+			}
+			transform.SetPosition(m_Transform2dManager->WorldToLocalPosition(entity,
+				meter2pixel(body2d.GetBody()->GetPosition()) - static_cast<sf::Vector2f>(body2d.GetOffset())));
 		}
+	});
+}
+
+void Body2dManager::SaveSnapshot(Snapshot& snapshot)
+{
+	m_SnapshotBodies.clear();
+	m_Components.ForEach([this](Entity entity, Body2d& body2d)
+	{
+		if (const auto* body = body2d.GetBody())
+		{
+			m_SnapshotBodies.push_back({ entity, body->GetPosition(), body->GetAngle(),
+				body->GetLinearVelocity(), body->GetAngularVelocity(), body->IsAwake() });
+		}
+	});
+	snapshot.WriteArray(m_SnapshotBodies.data(), m_SnapshotBodies.size());
+}
+
+void Body2dManager::RestoreSnapshot(Snapshot& snapshot)
+{
+	size_t bodyNmb = 0;
+	const auto* bodyStates = snapshot.ReadArray<BodyState>(bodyNmb);
+	for (size_t i = 0; i < bodyNmb; i++)
+	{
+		const auto& bodyState = bodyStates[i];
+		auto* body2d = m_Components.Get(bodyState.entity);
+		if (body2d == nullptr || body2d->GetBody() == nullptr)
+		{
+			continue;
+		}
+		auto* body = body2d->GetBody();
+		body->SetTransform(bodyState.position, bodyState.angle);
+		//Putting a body to sleep clears its velocities, so it is done first
+		body->SetAwake(bodyState.awake);
+		body->SetLinearVelocity(bodyState.linearVelocity);
+		body->SetAngularVelocity(bodyState.angularVelocity);
 	}
 }
 
@@ -176,21 +246,33 @@ Body2d* Body2dManager::AddComponent(Entity entity)
 		b2BodyDef bodyDef;
 		bodyDef.type = b2_dynamicBody;
 
-		auto* transform = m_Transform2dManager->GetComponentPtr(entity);
-		const auto pos = transform->Position;
+		auto* body2d = GetOrCreateComponent(entity);
+		if (body2d == nullptr)
+		{
+			return nullptr;
+		}
+		//A body always moves a transform
+		if (!m_Transform2dManager->HasTransform(entity))
+		{
+			m_Transform2dManager->AddComponent(entity);
+		}
+		const auto pos = m_Transform2dManager->GetWorldTransform(entity).Position;
 		bodyDef.position.Set(pixel2meter(pos.x), pixel2meter(pos.y));
 
 		auto* body = world->CreateBody(&bodyDef);
-		m_Components[entity - 1] = Body2d(transform, sf::Vector2f());
-		m_Components[entity - 1].SetBody(body);
+		//Adding the transform can move the body to another archetype chunk
+		body2d = GetComponentPtr(entity);
+		*body2d = Body2d(m_Transform2dManager->GetComponentPtr(entity), sf::Vector2f());
+		body2d->SetBody(body);
 
-		auto& componentInfo = m_ComponentsInfo[entity-1];
-		componentInfo.bodyManager = this;
-		componentInfo.SetEntity(entity);
-		componentInfo.name = "Body";
+		if (auto* componentInfo = GetComponentInfo(entity))
+		{
+			componentInfo->bodyManager = this;
+			componentInfo->SetEntity(entity);
+			componentInfo->name = "Body";
+		}
 
-		m_EntityManager->AddComponentType(entity, ComponentType::BODY2D);
-		return &m_Components[entity - 1];
+		return body2d;
 	}
 	return nullptr;
 }
@@ -213,30 +295,64 @@ void Body2dManager::CreateComponent(json& componentJson, Entity entity)
 		const auto offset = GetVectorFromJson(componentJson, "offset");
 		const auto velocity = GetVectorFromJson(componentJson, "velocity");
 
-		auto* transform = m_Transform2dManager->GetComponentPtr(entity);
-		const auto pos = transform->Position + offset;
+		auto* body2d = GetOrCreateComponent(entity);
+		if (body2d == nullptr)
+		{
+			return;
+		}
+		if (!m_Transform2dManager->HasTransform(entity))
+		{
+			m_Transform2dManager->AddComponent(entity);
+		}
+		const auto pos = m_Transform2dManager->GetWorldTransform(entity).Position + offset;
 		bodyDef.position.Set(pixel2meter(pos.x), pixel2meter(pos.y));
 		
 		auto* body = world->CreateBody(&bodyDef);
 		body->SetLinearVelocity(pixel2meter(velocity));
-		m_Components[entity - 1] = Body2d(transform, offset);
-		m_Components[entity - 1].SetBody(body);
+		body2d = GetComponentPtr(entity);
+		*body2d = Body2d(m_Transform2dManager->GetComponentPtr(entity), offset);
+		body2d->SetBody(body);
 
 
-		m_ComponentsInfo[entity - 1].bodyManager = this;
-		m_ComponentsInfo[entity - 1].SetEntity(entity);
+		if (auto* componentInfo = GetComponentInfo(entity))
+		{
+			componentInfo->bodyManager = this;
+		}
 	}
 }
 
 void Body2dManager::DestroyComponent(Entity entity)
 {
-	(void) entity;
+	m_EntityManager->RemoveComponentType(entity, ComponentType::BODY2D);
+	OnDestroy(entity);
+}
+
+void Body2dManager::OnDestroy(Entity entity)
+{
+	auto* body2d = GetComponentPtr(entity);
+	if (body2d == nullptr)
+	{
+		return;
+	}
+	if (auto world = m_WorldPtr.lock())
+	{
+		if (body2d->GetBody() != nullptr)
+		{
+			world->DestroyBody(body2d->GetBody());
+		}
+	}
+	RemoveComponent(entity);
+}
+
+void Body2dManager::OnBeforeSceneLoad()
+{
+	//The bodies are destroyed with the world
+	SingleComponentManager::OnBeforeSceneLoad();
 }
 
 void Body2dManager::OnResize(size_t new_size)
 {
-	m_Components.resize(new_size);
-	m_ComponentsInfo.resize(new_size);
+	SingleComponentManager::OnResize(new_size);
 }
 }
 
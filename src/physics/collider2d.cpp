@@ -68,9 +68,9 @@ void ColliderManager::OnEngineInit()
 void ColliderManager::CreateComponent(json& componentJson, Entity entity)
 {
 	Log::GetInstance()->Msg("Create component Collider");
-	if (m_EntityManager->HasComponent(entity, ComponentType::BODY2D))
+	auto* body = m_BodyManager->GetComponentPtr(entity);
+	if (body != nullptr)
 	{
-		auto & body = m_BodyManager->GetComponentRef(entity);
 
 		b2FixtureDef fixtureDef;
 
@@ -129,15 +129,18 @@ void ColliderManager::CreateComponent(json& componentJson, Entity entity)
 			auto index = GetFreeComponentIndex();
 			if(index != -1)
 			{
-				auto fixture = body.GetBody()->CreateFixture(&fixtureDef);
+				auto fixture = body->GetBody()->CreateFixture(&fixtureDef);
 
 
 				ColliderData& colliderData = m_Components[index];
 				colliderData.entity = entity;
 				colliderData.fixture = fixture;
-				colliderData.body = body.GetBody();
-				m_ComponentsInfo[index].data = &colliderData;
-				m_ComponentsInfo[index].SetEntity(entity);
+				colliderData.body = body->GetBody();
+				if (m_StoreComponentsInfo)
+				{
+					m_ComponentsInfo[index].data = &colliderData;
+					m_ComponentsInfo[index].SetEntity(entity);
+				}
 				fixture->SetUserData(&colliderData);
 			}
 		}
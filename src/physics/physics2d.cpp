@@ -84,6 +84,7 @@ void Physics2dManager::Destroy()
 
 void Physics2dManager::OnBeforeSceneLoad()
 {
+	m_BodyManager.OnBeforeSceneLoad();
 	Destroy();
 	OnEngineInit();
 }
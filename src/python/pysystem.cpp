@@ -8,6 +8,8 @@
 #include <physics/collider2d.h>
 #include <python/pysystem.h>
 #include <python/python_engine.h>
+#include <engine/snapshot.h>
+#include <engine/task_graph.h>
 #include <pybind11/operators.h>
 #include <pybind11/stl.h>
 #include <utility/python_utility.h>
@@ -115,6 +117,79 @@ void PySystem::OnEditorDraw()
 	}
 }
 
+bool PySystem::SaveState(std::string& state)
+{
+	try
+	{
+		const py::function saveState = py::get_overload(static_cast<const System*>(this), "save_state");
+		if (!saveState)
+		{
+			return false;
+		}
+		state = saveState().cast<std::string>();
+		return true;
+	}
+	catch (std::runtime_error& e)
+	{
+		std::stringstream oss;
+		oss << "Python error on PySystem SaveState\n" << e.what();
+		Log::GetInstance()->Error(oss.str());
+	}
+	return false;
+}
+
+void PySystem::RestoreState(const std::string& state)
+{
+	try
+	{
+		const py::function restoreState = py::get_overload(static_cast<const System*>(this), "restore_state");
+		if (restoreState)
+		{
+			restoreState(py::bytes(state));
+		}
+	}
+	catch (std::runtime_error& e)
+	{
+		std::stringstream oss;
+		oss << "Python error on PySystem RestoreState\n" << e.what();
+		Log::GetInstance()->Error(oss.str());
+	}
+}
+
+static EntityMask GetComponentMask(const py::handle& componentTypes)
+{
+	EntityMask mask = 0;
+	for (auto componentType : componentTypes)
+	{
+		mask |= static_cast<EntityMask>(componentType.cast<ComponentType>());
+	}
+	return mask;
+}
+
+void PySystem::GetComponentAccess(EntityMask& readMask, EntityMask& writeMask)
+{
+	readMask = ALL_COMPONENTS_MASK;
+	writeMask = ALL_COMPONENTS_MASK;
+	try
+	{
+		const py::handle self = py::detail::get_object_handle(static_cast<const System*>(this),
+			py::detail::get_type_info(typeid(System)));
+		if (!self || !py::hasattr(self, "read_components") || !py::hasattr(self, "write_components"))
+		{
+			return;
+		}
+		const EntityMask declaredReadMask = GetComponentMask(self.attr("read_components"));
+		writeMask = GetComponentMask(self.attr("write_components"));
+		readMask = declaredReadMask;
+	}
+	catch (std::runtime_error& e)
+	{
+		std::stringstream oss;
+		oss << "Python error on PySystem GetComponentAccess\n" << e.what();
+		Log::GetInstance()->Error(oss.str());
+	}
+}
+
 void PySystem::OnContact(ColliderData* c1, ColliderData* c2, bool enter)
 {
 	try
@@ -264,4 +339,36 @@ std::vector<PySystem*>& PySystemManager::GetPySystems()
 {
 	return m_PySystems;
 }
+
+void PySystemManager::SaveSnapshot(Snapshot& snapshot)
+{
+	std::string state;
+	for (auto* pySystem : m_PySystems)
+	{
+		if (pySystem == nullptr)
+		{
+			continue;
+		}
+		state.clear();
+		pySystem->SaveState(state);
+		snapshot.WriteArray(state.data(), state.size());
+	}
+}
+
+void PySystemManager::RestoreSnapshot(Snapshot& snapshot)
+{
+	for (auto* pySystem : m_PySystems)
+	{
+		if (pySystem == nullptr)
+		{
+			continue;
+		}
+		size_t stateSize = 0;
+		const auto* state = snapshot.ReadArray<char>(stateSize);
+		if (state != nullptr && stateSize > 0)
+		{
+			pySystem->RestoreState(std::string(state, stateSize));
+		}
+	}
+}
 }
@@ -61,6 +61,23 @@
 namespace sfge
 {
 
+/**
+ * \brief Refuse the entity creations and the added components of the python systems running beside the jobs,
+ * whose masks do not protect the component arrays from being reallocated under the workers
+ */
+static bool CheckStructuralChange(Engine& engine, const char* functionName)
+{
+	if (!engine.GetEntityManager()->AreStructuralChangesLocked())
+	{
+		return true;
+	}
+	std::ostringstream oss;
+	oss << "[Error] Python cannot call " << functionName <<
+		" in a system declaring read_components and write_components, do it in init or fixed_update";
+	Log::GetInstance()->Error(oss.str());
+	return false;
+}
+
 PYBIND11_EMBEDDED_MODULE(SFGE, m)
 {
 	py::class_<Engine> engine(m, "Engine");
@@ -68,7 +85,8 @@ PYBIND11_EMBEDDED_MODULE(SFGE, m)
 		.def_property_readonly("config", [](Engine* engine)
 	{
 		return engine->GetConfig();
-	}, py::return_value_policy::reference);
+	}, py::return_value_policy::reference)
+		.def_readwrite("running", &Engine::running);
 
 	py::class_<Configuration, std::unique_ptr<Configuration, py::nodelete>> config(m, "Configuration");
 	config
@@ -82,11 +100,24 @@ PYBIND11_EMBEDDED_MODULE(SFGE, m)
 		.def("on_draw", &System::OnDraw)
 		.def("on_contact", &System::OnContact);
 
+	py::class_<Prefab> prefab(m, "Prefab");
+	prefab
+		.def_readonly("name", &Prefab::name);
+
 	py::class_<SceneManager> sceneManager(m, "SceneManager");
 	sceneManager
 		.def(py::init<Engine&>(), py::return_value_policy::reference)
 		.def("load_scene", &SceneManager::LoadSceneFromName)
-		.def("get_scenes", &SceneManager::GetAllScenes);
+		.def("get_scenes", &SceneManager::GetAllScenes)
+		.def("load_prefab", &SceneManager::LoadPrefabFromPath)
+		.def("instantiate_prefab", [](SceneManager* sceneManager, Prefab& prefab, size_t count)
+		{
+			if (!CheckStructuralChange(sceneManager->GetEngine(), "instantiate_prefab"))
+			{
+				return std::vector<Entity>();
+			}
+			return sceneManager->InstantiatePrefab(prefab, count);
+		});
 
 	py::class_<InputManager> inputManager(m, "InputManager");
 	inputManager
@@ -118,18 +149,77 @@ PYBIND11_EMBEDDED_MODULE(SFGE, m)
 	py::class_<Transform2dManager> transform2dManager(m , "Transform2dManager");
 	transform2dManager
 	    .def(py::init<Engine&>(), py::return_value_policy::reference)
-		.def("add_component", &Transform2dManager::AddComponent, py::return_value_policy::reference)
-	    .def("get_component", &Transform2dManager::GetComponentRef, py::return_value_policy::reference);
+		.def("add_component", [](Transform2dManager* transformManager, Entity entity) -> py::object
+		{
+			if (!CheckStructuralChange(transformManager->GetEngine(), "add_component"))
+			{
+				return py::none();
+			}
+			transformManager->AddComponent(entity);
+			auto transform = transformManager->GetComponentRef(entity);
+			return transform.IsValid() ? py::cast(transform) : py::none();
+		})
+		//The scripts get a handle working with both storages of the transforms
+	    .def("get_component", [](Transform2dManager* transformManager, Entity entity) -> py::object
+		{
+			auto transform = transformManager->GetComponentRef(entity);
+			return transform.IsValid() ? py::cast(transform) : py::none();
+		})
+		.def("set_parent", &Transform2dManager::SetParent)
+		.def("get_parent", &Transform2dManager::GetParent)
+		.def("get_world_transform", &Transform2dManager::GetWorldTransform);
 
 	py::class_<EntityManager> entityManager(m, "EntityManager");
 	entityManager
 	    .def(py::init<Engine&>(), py::return_value_policy::reference)
-	    .def("create_entity", &EntityManager::CreateEntity)
-	    .def("destroy_entity", &EntityManager::DestroyEntity)
+	    .def("create_entity", [](EntityManager* entityManager, Entity wantedEntity)
+		{
+			if (!CheckStructuralChange(entityManager->GetEngine(), "create_entity"))
+			{
+				return INVALID_ENTITY;
+			}
+			return entityManager->CreateEntity(wantedEntity);
+		})
+		.def("create_entities", [](EntityManager* entityManager, size_t count)
+		{
+			if (!CheckStructuralChange(entityManager->GetEngine(), "create_entities"))
+			{
+				return std::vector<Entity>();
+			}
+			return entityManager->CreateEntities(count);
+		})
+	    .def("destroy_entity", [](EntityManager* entityManager, Entity entity)
+		{
+			//The entity is destroyed at the sync point after the systems, like from a job
+			if (entityManager->AreStructuralChangesLocked())
+			{
+				entityManager->GetCommandBuffer().DestroyEntity(entity);
+				return;
+			}
+			entityManager->DestroyEntity(entity);
+		})
+		.def("is_valid", &EntityManager::IsEntityValid)
 		.def("get_entity", &EntityManager::GetEntityByName)
-	    .def("has_component", &EntityManager::HasComponent)
-		.def("resize", &EntityManager::ResizeEntityNmb)
-		.def("get_entities_with_type", &EntityManager::GetEntitiesWithType);
+		.def("get_entities", &EntityManager::GetEntitiesByName)
+	    .def("has_component", py::overload_cast<Entity, ComponentType>(&EntityManager::HasComponent))
+		.def("resize", [](EntityManager* entityManager, size_t newSize)
+		{
+			if (CheckStructuralChange(entityManager->GetEngine(), "resize"))
+			{
+				entityManager->ResizeEntityNmb(newSize);
+			}
+		})
+		.def("get_entities_with_type", &EntityManager::GetEntitiesWithType)
+		.def("get_query", py::overload_cast<const std::vector<ComponentType>&>(&EntityManager::GetQuery), py::return_value_policy::reference);
+
+	py::class_<EntityQuery> entityQuery(m, "EntityQuery");
+	entityQuery
+		.def("__len__", &EntityQuery::Size)
+		.def("__iter__", [](const EntityQuery& query)
+		{
+			//The script can create or destroy entities in the loop, so it walks a copy of the entities
+			return py::iter(py::cast(query.GetEntities()));
+		});
 
 	py::class_<Physics2dManager> physics2dManager(m, "Physics2dManager");
 	physics2dManager
@@ -144,8 +234,15 @@ PYBIND11_EMBEDDED_MODULE(SFGE, m)
 
 	py::class_<Body2dManager> body2dManager(m, "Body2dManager");
 	body2dManager
-	    .def("add_component", &Body2dManager::AddComponent, py::return_value_policy::reference)
-	    .def("get_component", &Body2dManager::GetComponentRef, py::return_value_policy::reference);
+	    .def("add_component", [](Body2dManager* bodyManager, Entity entity) -> Body2d*
+		{
+			if (!CheckStructuralChange(bodyManager->GetEngine(), "add_component"))
+			{
+				return nullptr;
+			}
+			return bodyManager->AddComponent(entity);
+		}, py::return_value_policy::reference)
+	    .def("get_component", &Body2dManager::GetComponentPtr, py::return_value_policy::reference);
 
 	py::class_<Graphics2dManager> graphics2dManager(m, "Graphics2dManager");
 	graphics2dManager
@@ -169,17 +266,27 @@ PYBIND11_EMBEDDED_MODULE(SFGE, m)
 	spriteManager
 		.def("create_component", [](SpriteManager* spriteManager, Entity entity, std::string texturePath)
 		{
+			if (!CheckStructuralChange(spriteManager->GetEngine(), "create_component"))
+			{
+				return;
+			}
 			TextureManager* textureManager = spriteManager->GetEngine().GetGraphics2dManager()->GetTextureManager();
 
 			const auto textureId = textureManager->LoadTexture(texturePath);
 			auto* texture = textureManager->GetTexture(textureId);
 			auto* sprite = spriteManager->AddComponent(entity);
+			if (sprite == nullptr)
+			{
+				return;
+			}
 			sprite->SetTexture(texture);
 
-			auto& spriteInfo = spriteManager->GetComponentInfo(entity);
-			spriteInfo.name = "Sprite";
-			spriteInfo.textureId = textureId;
-			spriteInfo.texturePath = texturePath;
+			if (auto* spriteInfo = spriteManager->GetComponentInfo(entity))
+			{
+				spriteInfo->name = "Sprite";
+				spriteInfo->textureId = textureId;
+				spriteInfo->texturePath = texturePath;
+			}
 		}, py::return_value_policy::reference)
 		.def("get_component", &SpriteManager::GetComponentPtr, py::return_value_policy::reference);
 
@@ -213,6 +320,13 @@ PYBIND11_EMBEDDED_MODULE(SFGE, m)
 		.def_readwrite("position", &Transform2d::Position)
 		.def_readwrite("scale", &Transform2d::Scale);
 
+	py::class_<Transform2dRef> transformRef(m, "Transform2dRef");
+	transformRef
+		.def_property("euler_angle", &Transform2dRef::GetEulerAngle, &Transform2dRef::SetEulerAngle)
+		.def_property("position", &Transform2dRef::GetPosition, &Transform2dRef::SetPosition)
+		.def_property("scale", &Transform2dRef::GetScale, &Transform2dRef::SetScale)
+		.def_property_readonly("entity", &Transform2dRef::GetEntity);
+
 	py::class_<ColliderData> colliderData(m, "ColliderData");
 	colliderData
 		.def_readonly("body", &ColliderData::body)
@@ -0,0 +1,203 @@
+/*
+MIT License
+
+Copyright (c) 2017 SAE Institute Switzerland AG
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <gtest/gtest.h>
+#include <atomic>
+#include <string>
+
+#include <engine/archetype_storage.h>
+#include <engine/component_storage.h>
+
+struct TestPosition
+{
+	float x = 0.0f;
+	std::string name;
+};
+
+struct TestVelocity
+{
+	double value = 0.0;
+};
+
+TEST(ArchetypeStorage, TestAddRemoveComponents)
+{
+	sfge::ArchetypeStorage archetypeStorage;
+	archetypeStorage.RegisterComponentType<TestPosition>(0);
+	archetypeStorage.RegisterComponentType<TestVelocity>(3);
+	const unsigned entityNmb = 5000;
+	for (Entity entity = 1; entity <= entityNmb; entity++)
+	{
+		auto* position = static_cast<TestPosition*>(archetypeStorage.AddComponent(entity, 0));
+		position->x = static_cast<float>(entity);
+		position->name = std::to_string(entity);
+		if (entity % 2 == 1)
+		{
+			static_cast<TestVelocity*>(archetypeStorage.AddComponent(entity, 3))->value = entity * 2.0;
+		}
+	}
+	EXPECT_EQ(archetypeStorage.GetComponentNmb(0), entityNmb);
+	EXPECT_EQ(archetypeStorage.GetComponentNmb(3), entityNmb / 2);
+
+	for (Entity entity = 1; entity <= entityNmb; entity += 3)
+	{
+		archetypeStorage.RemoveComponent(entity, 0);
+	}
+	size_t expectedRowNmb = 0;
+	for (Entity entity = 1; entity <= entityNmb; entity++)
+	{
+		if ((entity - 1) % 3 != 0 && entity % 2 == 1)
+		{
+			expectedRowNmb++;
+		}
+		auto* position = static_cast<TestPosition*>(archetypeStorage.GetComponent(entity, 0));
+		if ((entity - 1) % 3 == 0)
+		{
+			EXPECT_EQ(position, nullptr);
+		}
+		else
+		{
+			ASSERT_NE(position, nullptr);
+			EXPECT_EQ(position->name, std::to_string(entity));
+		}
+		EXPECT_EQ(archetypeStorage.HasComponent(entity, 3), entity % 2 == 1);
+	}
+
+	size_t rowNmb = 0;
+	archetypeStorage.ForEachChunk(1 | 8, [&rowNmb](const sfge::ArchetypeChunkView& chunk)
+	{
+		auto* positions = chunk.GetColumn<TestPosition>(0);
+		auto* velocities = chunk.GetColumn<TestVelocity>(3);
+		for (size_t i = 0; i < chunk.count; i++)
+		{
+			EXPECT_EQ(positions[i].x, static_cast<float>(chunk.entities[i]));
+			EXPECT_EQ(velocities[i].value, chunk.entities[i] * 2.0);
+			rowNmb++;
+		}
+	});
+	EXPECT_EQ(rowNmb, expectedRowNmb);
+
+	for (Entity entity = 1; entity <= entityNmb; entity++)
+	{
+		archetypeStorage.RemoveEntity(entity);
+	}
+	EXPECT_EQ(archetypeStorage.GetComponentNmb(0), 0u);
+	EXPECT_EQ(archetypeStorage.GetComponentNmb(3), 0u);
+}
+
+TEST(ArchetypeStorage, TestComponentStorage)
+{
+	sfge::JobSystem jobSystem;
+	jobSystem.Init(3);
+	sfge::ArchetypeStorage archetypeStorage;
+	archetypeStorage.RegisterComponentType<TestVelocity>(1);
+	sfge::ComponentStorage<TestVelocity> components;
+	components.UseArchetypeStorage(&archetypeStorage, 1);
+	for (Entity entity = 1; entity <= 1000; entity++)
+	{
+		components.Insert(entity)->value = entity;
+	}
+	components.Remove(10);
+	EXPECT_FALSE(components.Contains(10));
+	EXPECT_EQ(components.Size(), 999u);
+
+	components.ParallelForEach(jobSystem, [](Entity entity, TestVelocity& velocity)
+	{
+		velocity.value += entity;
+	});
+	std::atomic<size_t> count{ 0 };
+	components.ForEach([&count](Entity entity, TestVelocity& velocity)
+	{
+		EXPECT_EQ(velocity.value, entity * 2.0);
+		count++;
+	});
+	EXPECT_EQ(count, 999u);
+	jobSystem.Destroy();
+}
+
+TEST(ArchetypeStorage, TestOutdatedEntity)
+{
+	sfge::ArchetypeStorage archetypeStorage;
+	archetypeStorage.RegisterComponentType<TestPosition>(0);
+	archetypeStorage.RegisterComponentType<TestVelocity>(3);
+	const auto oldEntity = MakeEntity(7, 0);
+	static_cast<TestPosition*>(archetypeStorage.AddComponent(oldEntity, 0))->x = 1.0f;
+	archetypeStorage.RemoveEntity(oldEntity);
+
+	const auto newEntity = MakeEntity(7, 1);
+	static_cast<TestPosition*>(archetypeStorage.AddComponent(newEntity, 0))->x = 2.0f;
+	//The outdated handle can neither read the row of the new entity nor move it to another archetype
+	EXPECT_EQ(nullptr, archetypeStorage.AddComponent(oldEntity, 3));
+	EXPECT_EQ(nullptr, archetypeStorage.AddComponent(oldEntity, 0));
+	EXPECT_EQ(nullptr, archetypeStorage.GetComponent(oldEntity, 0));
+	EXPECT_FALSE(archetypeStorage.HasComponent(newEntity, 3));
+	const auto* position = static_cast<TestPosition*>(archetypeStorage.GetComponent(newEntity, 0));
+	ASSERT_NE(nullptr, position);
+	EXPECT_EQ(2.0f, position->x);
+	EXPECT_EQ(1u, archetypeStorage.GetComponentNmb(0));
+	EXPECT_EQ(0u, archetypeStorage.GetComponentNmb(3));
+}
+
+TEST(ArchetypeStorage, TestParallelForEachChunk)
+{
+	sfge::JobSystem jobSystem;
+	jobSystem.Init(3);
+	sfge::ArchetypeStorage archetypeStorage;
+	archetypeStorage.RegisterComponentType<TestPosition>(0);
+	archetypeStorage.RegisterComponentType<TestVelocity>(1);
+	archetypeStorage.RegisterComponentType<TestVelocity>(2);
+	//Velocities spread over three archetypes, one of them empty, with several chunks each
+	const unsigned entityNmb = 6000;
+	for (Entity entity = 1; entity <= entityNmb; entity++)
+	{
+		static_cast<TestVelocity*>(archetypeStorage.AddComponent(entity, 1))->value = entity;
+		if (entity % 3 == 0)
+		{
+			archetypeStorage.AddComponent(entity, 0);
+		}
+		else if (entity % 3 == 1)
+		{
+			archetypeStorage.AddComponent(entity, 2);
+		}
+	}
+	archetypeStorage.AddComponent(entityNmb + 1, 0);
+	archetypeStorage.AddComponent(entityNmb + 1, 2);
+	archetypeStorage.RemoveEntity(entityNmb + 1);
+
+	std::atomic<size_t> rowNmb{0};
+	archetypeStorage.ParallelForEachChunk(jobSystem, sfge::EntityMask(1) << 1, [&rowNmb](const sfge::ArchetypeChunkView& chunk)
+	{
+		auto* velocities = chunk.GetColumn<TestVelocity>(1);
+		for (size_t i = 0; i < chunk.count; i++)
+		{
+			velocities[i].value += chunk.entities[i];
+		}
+		rowNmb += chunk.count;
+	});
+	EXPECT_EQ(entityNmb, rowNmb.load());
+	for (Entity entity = 1; entity <= entityNmb; entity++)
+	{
+		EXPECT_EQ(entity * 2.0, static_cast<TestVelocity*>(archetypeStorage.GetComponent(entity, 1))->value);
+	}
+	jobSystem.Destroy();
+}
@@ -0,0 +1,333 @@
+/*
+MIT License
+
+Copyright (c) 2017 SAE Institute Switzerland AG
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#include <gtest/gtest.h>
+#include <map>
+#include <vector>
+
+#include <engine/component_storage.h>
+#include <engine/config.h>
+#include <engine/engine.h>
+#include <engine/entity.h>
+#include <engine/transform2d.h>
+
+TEST(ComponentStorage, TestInsertRemove)
+{
+	sfge::ComponentStorage<int> components;
+	components.ResizeEntityNmb(16);
+	for (size_t entityIndex = 0; entityIndex < 8; entityIndex++)
+	{
+		*components.Insert(MakeEntity(entityIndex, 0)) = static_cast<int>(entityIndex);
+	}
+	EXPECT_EQ(8u, components.Size());
+	//Inserting again returns the same component
+	EXPECT_EQ(3, *components.Insert(MakeEntity(3, 0)));
+	EXPECT_EQ(8u, components.Size());
+
+	components.Remove(MakeEntity(3, 0));
+	EXPECT_EQ(7u, components.Size());
+	EXPECT_FALSE(components.Contains(MakeEntity(3, 0)));
+	EXPECT_EQ(nullptr, components.Get(MakeEntity(3, 0)));
+	for (size_t entityIndex = 0; entityIndex < 8; entityIndex++)
+	{
+		if (entityIndex == 3)
+		{
+			continue;
+		}
+		const auto* component = components.Get(MakeEntity(entityIndex, 0));
+		ASSERT_NE(nullptr, component);
+		EXPECT_EQ(static_cast<int>(entityIndex), *component);
+	}
+	//Removing twice does nothing
+	components.Remove(MakeEntity(3, 0));
+	EXPECT_EQ(7u, components.Size());
+}
+
+TEST(ComponentStorage, TestReuseEntityIndex)
+{
+	sfge::ComponentStorage<int> components;
+	components.ResizeEntityNmb(16);
+	const auto oldEntity = MakeEntity(5, 0);
+	*components.Insert(oldEntity) = 42;
+	components.Remove(oldEntity);
+
+	//The index comes back with the next version, the new component is default constructed
+	const auto newEntity = MakeEntity(5, 1);
+	EXPECT_EQ(0, *components.Insert(newEntity));
+	EXPECT_TRUE(components.Contains(newEntity));
+	EXPECT_FALSE(components.Contains(oldEntity));
+	EXPECT_EQ(nullptr, components.Get(oldEntity));
+	EXPECT_EQ(1u, components.Size());
+}
+
+TEST(ComponentStorage, TestOutdatedEntity)
+{
+	sfge::ComponentStorage<int> components;
+	components.ResizeEntityNmb(16);
+	const auto oldEntity = MakeEntity(5, 0);
+	*components.Insert(oldEntity) = 1;
+	components.Remove(oldEntity);
+	const auto newEntity = MakeEntity(5, 1);
+	*components.Insert(newEntity) = 2;
+
+	//The outdated handle does not get the component of the entity reusing its index
+	EXPECT_EQ(nullptr, components.Insert(oldEntity));
+	EXPECT_EQ(nullptr, components.Get(oldEntity));
+	EXPECT_FALSE(components.Contains(oldEntity));
+	components.Remove(oldEntity);
+	ASSERT_NE(nullptr, components.Get(newEntity));
+	EXPECT_EQ(2, *components.Get(newEntity));
+	EXPECT_EQ(1u, components.Size());
+}
+
+TEST(ComponentStorage, TestStablePointers)
+{
+	sfge::ComponentStorage<int> components;
+	components.ResizeEntityNmb(16);
+	std::vector<int*> pointers;
+	for (size_t entityIndex = 0; entityIndex < 8; entityIndex++)
+	{
+		pointers.push_back(components.Insert(MakeEntity(entityIndex, 0)));
+		*pointers.back() = static_cast<int>(entityIndex);
+	}
+	//Removing a component does not move the others
+	components.Remove(MakeEntity(2, 0));
+	components.Remove(MakeEntity(0, 0));
+	for (size_t entityIndex = 0; entityIndex < 8; entityIndex++)
+	{
+		if (entityIndex == 0 || entityIndex == 2)
+		{
+			continue;
+		}
+		EXPECT_EQ(pointers[entityIndex], components.Get(MakeEntity(entityIndex, 0)));
+		EXPECT_EQ(static_cast<int>(entityIndex), *pointers[entityIndex]);
+	}
+	EXPECT_EQ(6u, components.Size());
+
+	//The free slots are reused, default constructed, before the packed array grows
+	auto* component = components.Insert(MakeEntity(8, 0));
+	EXPECT_TRUE(component == pointers[0] || component == pointers[2]);
+	EXPECT_EQ(0, *component);
+	components.Insert(MakeEntity(9, 0));
+	EXPECT_EQ(8u, components.GetComponents().size());
+	EXPECT_EQ(8u, components.Size());
+
+	size_t componentNmb = 0;
+	components.ForEach([&componentNmb](Entity entity, int&)
+	{
+		EXPECT_NE(INVALID_ENTITY, entity);
+		componentNmb++;
+	});
+	EXPECT_EQ(8u, componentNmb);
+}
+
+TEST(ComponentStorage, TestForEach)
+{
+	sfge::ComponentStorage<int> components;
+	components.ResizeEntityNmb(64);
+	std::map<Entity, int> expectedComponents;
+	for (size_t entityIndex = 0; entityIndex < 64; entityIndex++)
+	{
+		const auto entity = MakeEntity(entityIndex, 0);
+		*components.Insert(entity) = static_cast<int>(entityIndex) * 10;
+		expectedComponents[entity] = static_cast<int>(entityIndex) * 10;
+	}
+	for (size_t entityIndex = 0; entityIndex < 64; entityIndex += 3)
+	{
+		const auto entity = MakeEntity(entityIndex, 0);
+		components.Remove(entity);
+		expectedComponents.erase(entity);
+	}
+	size_t componentNmb = 0;
+	components.ForEach([&expectedComponents, &componentNmb](Entity entity, int& component)
+	{
+		const auto expectedIt = expectedComponents.find(entity);
+		ASSERT_NE(expectedComponents.end(), expectedIt);
+		EXPECT_EQ(expectedIt->second, component);
+		componentNmb++;
+	});
+	EXPECT_EQ(expectedComponents.size(), componentNmb);
+	EXPECT_EQ(expectedComponents.size(), components.Size());
+
+	sfge::JobSystem jobSystem;
+	jobSystem.Init(3);
+	components.ParallelForEach(jobSystem, [](Entity, int& component)
+	{
+		component++;
+	});
+	components.ForEach([&expectedComponents](Entity entity, int& component)
+	{
+		EXPECT_EQ(expectedComponents[entity] + 1, component);
+	});
+	jobSystem.Destroy();
+}
+
+TEST(ComponentStorage, TestEntityOrder)
+{
+	sfge::ComponentStorage<int> components;
+	components.ResizeEntityNmb(64);
+	//Inserted from the last entity, so the packed array is in reverse entity order
+	for (size_t entityIndex = 32; entityIndex > 0; entityIndex--)
+	{
+		*components.Insert(MakeEntity(entityIndex - 1, 0)) = static_cast<int>(entityIndex - 1);
+	}
+	const auto checkEntityOrder = [&components](size_t expectedNmb)
+	{
+		std::vector<Entity> entities;
+		components.ForEach([&entities](Entity entity, int& component)
+		{
+			EXPECT_EQ(static_cast<int>(GetEntityIndex(entity)), component);
+			entities.push_back(entity);
+		});
+		EXPECT_EQ(expectedNmb, entities.size());
+		EXPECT_EQ(components.Size(), entities.size());
+		for (size_t i = 1; i < entities.size(); i++)
+		{
+			EXPECT_LT(GetEntityIndex(entities[i - 1]), GetEntityIndex(entities[i]));
+		}
+	};
+	checkEntityOrder(32);
+
+	//The free slots are skipped, then reused by entities of other indexes
+	for (size_t entityIndex = 0; entityIndex < 32; entityIndex += 2)
+	{
+		components.Remove(MakeEntity(entityIndex, 0));
+	}
+	checkEntityOrder(16);
+	for (size_t entityIndex = 40; entityIndex < 48; entityIndex++)
+	{
+		*components.Insert(MakeEntity(entityIndex, 0)) = static_cast<int>(entityIndex);
+	}
+	*components.Insert(MakeEntity(4, 1)) = 4;
+	components.Remove(MakeEntity(41, 0));
+	*components.Insert(MakeEntity(41, 1)) = 41;
+	checkEntityOrder(25);
+	EXPECT_EQ(32u, components.GetComponents().size());
+
+	sfge::JobSystem jobSystem;
+	jobSystem.Init(3);
+	components.Remove(MakeEntity(5, 0));
+	components.ParallelForEach(jobSystem, [](Entity entity, int& component)
+	{
+		EXPECT_NE(INVALID_ENTITY, entity);
+		component += 1000;
+	});
+	size_t componentNmb = 0;
+	components.ForEach([&componentNmb](Entity entity, int& component)
+	{
+		EXPECT_EQ(static_cast<int>(GetEntityIndex(entity)) + 1000, component);
+		componentNmb++;
+	});
+	EXPECT_EQ(24u, componentNmb);
+	jobSystem.Destroy();
+}
+
+static void CheckCreatedComponentsHaveMask(bool archetypeStorage)
+{
+	sfge::Engine engine;
+	auto config = std::make_unique<sfge::Configuration>();
+	config->devMode = false;
+	config->editor = false;
+	config->windowLess = true;
+	config->archetypeStorage = archetypeStorage;
+	engine.Init(std::move(config));
+
+	auto* entityManager = engine.GetEntityManager();
+	auto* transformManager = engine.GetTransform2dManager();
+	for (int i = 0; i < 10; i++)
+	{
+		const auto entity = entityManager->CreateEntity(INVALID_ENTITY);
+		auto* transform = transformManager->GetOrCreateComponent(entity);
+		ASSERT_NE(nullptr, transform);
+		EXPECT_TRUE(entityManager->HasComponent(entity, sfge::ComponentType::TRANSFORM2D));
+		EXPECT_EQ(transform, transformManager->GetOrCreateComponent(entity));
+		//Without the editor the infos are not stored
+		EXPECT_EQ(nullptr, transformManager->GetComponentInfo(entity));
+	}
+	//Every iterated component belongs to an entity with the component type
+	size_t componentNmb = 0;
+	transformManager->GetComponents().ForEach([entityManager, &componentNmb](Entity entity, sfge::Transform2d&)
+	{
+		EXPECT_TRUE(entityManager->HasComponent(entity, sfge::ComponentType::TRANSFORM2D));
+		componentNmb++;
+	});
+	EXPECT_EQ(10u, componentNmb);
+	EXPECT_EQ(nullptr, transformManager->GetOrCreateComponent(INVALID_ENTITY));
+	engine.Destroy();
+}
+
+TEST(ComponentStorage, TestCreateComponentSetsMask)
+{
+	CheckCreatedComponentsHaveMask(false);
+	CheckCreatedComponentsHaveMask(true);
+}
+
+TEST(ComponentStorage, TestOutdatedEntityLookups)
+{
+	sfge::Engine engine;
+	auto config = std::make_unique<sfge::Configuration>();
+	config->devMode = false;
+	config->editor = false;
+	config->windowLess = true;
+	engine.Init(std::move(config));
+
+	auto* entityManager = engine.GetEntityManager();
+	auto* transformManager = engine.GetTransform2dManager();
+	const auto oldEntity = entityManager->CreateEntity(INVALID_ENTITY);
+	transformManager->AddComponent(oldEntity)->Position = sf::Vector2f(1.0f, 1.0f);
+	entityManager->SetEntityName(oldEntity, "Old");
+	entityManager->DestroyEntity(oldEntity);
+
+	//The free index is reused with the next version
+	const auto newEntity = entityManager->CreateEntity(INVALID_ENTITY);
+	ASSERT_EQ(GetEntityIndex(oldEntity), GetEntityIndex(newEntity));
+	ASSERT_NE(oldEntity, newEntity);
+	transformManager->AddComponent(newEntity)->Position = sf::Vector2f(2.0f, 2.0f);
+	entityManager->SetEntityName(newEntity, "New");
+
+	EXPECT_FALSE(entityManager->IsEntityValid(oldEntity));
+	EXPECT_EQ(sfge::EntityMask(0), entityManager->GetMask(oldEntity));
+	EXPECT_FALSE(entityManager->HasComponent(oldEntity, sfge::ComponentType::TRANSFORM2D));
+	EXPECT_FALSE(entityManager->HasComponent<sfge::Transform2d>(oldEntity));
+	EXPECT_FALSE(entityManager->HasComponent<sfge::Transform2d>(INVALID_ENTITY));
+	//An index past the entities, like a handle kept from a bigger scene
+	EXPECT_FALSE(entityManager->HasComponent<sfge::Transform2d>(MakeEntity(INIT_ENTITY_NMB * 1000, 0)));
+	EXPECT_EQ(nullptr, entityManager->GetEntityInfo(oldEntity));
+	EXPECT_EQ(nullptr, transformManager->GetComponentPtr(oldEntity));
+	EXPECT_EQ(nullptr, transformManager->GetOrCreateComponent(oldEntity));
+	EXPECT_EQ(nullptr, transformManager->AddComponent(oldEntity));
+
+	//Writes through the outdated handle leave the new entity untouched
+	entityManager->AddComponentType(oldEntity, sfge::ComponentType::SPRITE2D);
+	entityManager->RemoveComponentType(oldEntity, sfge::ComponentType::TRANSFORM2D);
+	entityManager->SetEntityName(oldEntity, "Old");
+	EXPECT_EQ(sfge::EntityMask(sfge::ComponentType::TRANSFORM2D), entityManager->GetMask(newEntity));
+	ASSERT_NE(nullptr, entityManager->GetEntityInfo(newEntity));
+	EXPECT_EQ("New", entityManager->GetEntityInfo(newEntity)->name);
+	EXPECT_EQ(newEntity, entityManager->GetEntityByName("New"));
+	EXPECT_EQ(INVALID_ENTITY, entityManager->GetEntityByName("Old"));
+	const auto* transform = transformManager->GetComponentPtr(newEntity);
+	ASSERT_NE(nullptr, transform);
+	EXPECT_EQ(2.0f, transform->Position.x);
+	engine.Destroy();
+}
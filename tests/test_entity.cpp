@@ -0,0 +1,215 @@
+/*
+MIT License
+
+Copyright (c) 2017 SAE Institute Switzerland AG
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <random>
+#include <vector>
+
+#include <engine/config.h>
+#include <engine/engine.h>
+#include <engine/entity.h>
+#include <engine/transform2d.h>
+#include <graphics/graphics2d.h>
+#include <graphics/sprite2d.h>
+#include <physics/body2d.h>
+#include <physics/physics2d.h>
+
+TEST(EntityCommandBuffer, TestFlushComponentsFromJobs)
+{
+	sfge::Engine engine;
+	auto config = std::make_unique<sfge::Configuration>();
+	config->devMode = false;
+	config->editor = false;
+	config->windowLess = true;
+	engine.Init(std::move(config));
+
+	auto* entityManager = engine.GetEntityManager();
+	auto* transformManager = engine.GetTransform2dManager();
+	auto* spriteManager = engine.GetGraphics2dManager()->GetSpriteManager();
+	auto* bodyManager = engine.GetPhysicsManager()->GetBodyManager();
+	const size_t entityNmb = 256;
+	const auto entities = entityManager->CreateEntities(entityNmb);
+	ASSERT_EQ(entityNmb, entities.size());
+
+	//Each job records in the buffer of its worker, the same component can be added twice
+	auto& jobSystem = engine.GetJobSystem();
+	jobSystem.ParallelFor(0, entityNmb, 8, [entityManager, &entities](size_t start, size_t end)
+	{
+		auto& commandBuffer = entityManager->GetCommandBuffer();
+		for (auto i = start; i < end; i++)
+		{
+			commandBuffer.AddComponentType(entities[i], sfge::ComponentType::TRANSFORM2D);
+			commandBuffer.AddComponentType(entities[i], sfge::ComponentType::TRANSFORM2D);
+			if (i % 2 == 0)
+			{
+				commandBuffer.AddComponentType(entities[i], sfge::ComponentType::SPRITE2D);
+			}
+			if (i % 16 == 0)
+			{
+				commandBuffer.CreateEntity(static_cast<sfge::EntityMask>(sfge::ComponentType::BODY2D));
+			}
+		}
+	});
+	//Nothing is applied before the flush
+	EXPECT_FALSE(entityManager->HasComponent(entities[0], sfge::ComponentType::TRANSFORM2D));
+	EXPECT_EQ(nullptr, transformManager->GetComponentPtr(entities[0]));
+	entityManager->FlushCommandBuffers();
+
+	for (size_t i = 0; i < entityNmb; i++)
+	{
+		EXPECT_TRUE(entityManager->HasComponent(entities[i], sfge::ComponentType::TRANSFORM2D));
+		EXPECT_NE(nullptr, transformManager->GetComponentPtr(entities[i]));
+		EXPECT_EQ(i % 2 == 0, entityManager->HasComponent(entities[i], sfge::ComponentType::SPRITE2D));
+		EXPECT_EQ(i % 2 == 0, spriteManager->GetComponentPtr(entities[i]) != nullptr);
+	}
+	EXPECT_EQ(entityNmb + entityNmb / 16, transformManager->GetComponents().Size());
+
+	//The created entities get their body from the body manager, with the transform it moves
+	std::vector<Entity> bodyEntities;
+	entityManager->FindEntities(static_cast<sfge::EntityMask>(sfge::ComponentType::BODY2D), 0, bodyEntities);
+	EXPECT_EQ(entityNmb / 16, bodyEntities.size());
+	for (auto entity : bodyEntities)
+	{
+		const auto* body2d = bodyManager->GetComponentPtr(entity);
+		ASSERT_NE(nullptr, body2d);
+		EXPECT_NE(nullptr, body2d->GetBody());
+		EXPECT_TRUE(entityManager->HasComponent(entity, sfge::ComponentType::TRANSFORM2D));
+		EXPECT_NE(nullptr, transformManager->GetComponentPtr(entity));
+	}
+
+	jobSystem.ParallelFor(0, entityNmb, 8, [entityManager, &entities](size_t start, size_t end)
+	{
+		auto& commandBuffer = entityManager->GetCommandBuffer();
+		for (auto i = start; i < end; i++)
+		{
+			commandBuffer.RemoveComponentType(entities[i], sfge::ComponentType::SPRITE2D);
+			if (i % 4 == 0)
+			{
+				commandBuffer.RemoveComponentType(entities[i], sfge::ComponentType::TRANSFORM2D);
+			}
+		}
+	});
+	entityManager->FlushCommandBuffers();
+	for (size_t i = 0; i < entityNmb; i++)
+	{
+		EXPECT_FALSE(entityManager->HasComponent(entities[i], sfge::ComponentType::SPRITE2D));
+		EXPECT_EQ(nullptr, spriteManager->GetComponentPtr(entities[i]));
+		EXPECT_EQ(i % 4 != 0, entityManager->HasComponent(entities[i], sfge::ComponentType::TRANSFORM2D));
+		EXPECT_EQ(i % 4 != 0, transformManager->GetComponentPtr(entities[i]) != nullptr);
+	}
+	EXPECT_EQ(0u, spriteManager->GetComponents().Size());
+	engine.Destroy();
+}
+
+/**
+ * \brief Compare the SIMD mask scans with a plain loop over the masks
+ */
+static void CheckFindEntities(size_t entityNmb)
+{
+	sfge::Engine engine;
+	auto config = std::make_unique<sfge::Configuration>();
+	config->devMode = false;
+	config->editor = false;
+	config->windowLess = true;
+	engine.Init(std::move(config));
+
+	auto* entityManager = engine.GetEntityManager();
+	entityManager->ResizeEntityNmb(entityNmb);
+	//Bits in both 32-bit halves, the SSE2 scan compares them separately
+	const int bits[] = { 0, 1, 3, 7, 31, 32, 33, 40, 63 };
+	std::mt19937 generator(static_cast<unsigned>(entityNmb));
+	const auto entities = entityManager->CreateEntities(entityNmb);
+	ASSERT_EQ(entityNmb, entities.size());
+	for (auto entity : entities)
+	{
+		for (auto bit : bits)
+		{
+			if (generator() % 2 == 0)
+			{
+				entityManager->AddComponentType(entity, static_cast<sfge::ComponentType>(sfge::EntityMask(1) << bit));
+			}
+		}
+	}
+	for (size_t i = 0; i < entities.size(); i += 5)
+	{
+		entityManager->DestroyEntity(entities[i]);
+	}
+
+	const sfge::EntityMask highBit = sfge::EntityMask(1) << 40;
+	const sfge::EntityMask masks[][2] = {
+		{ 0, 0 },
+		{ 1, 0 },
+		{ highBit, 0 },
+		{ (sfge::EntityMask(1) << 31) | (sfge::EntityMask(1) << 32), 0 },
+		{ 1 | highBit, sfge::EntityMask(1) << 63 },
+		{ sfge::EntityMask(1) << 3, 1 | (sfge::EntityMask(1) << 33) },
+		{ 0, highBit },
+	};
+	std::vector<Entity> foundEntities;
+	for (const auto& mask : masks)
+	{
+		const auto requiredMask = mask[0];
+		const auto excludedMask = mask[1];
+		std::vector<Entity> expectedEntities;
+		std::vector<Entity> expectedQueryEntities;
+		for (size_t entityIndex = 0; entityIndex < entityNmb; entityIndex++)
+		{
+			const auto entity = entityManager->GetEntityByIndex(entityIndex);
+			if (entity == INVALID_ENTITY)
+			{
+				continue;
+			}
+			const auto entityMask = entityManager->GetMask(entity);
+			if ((entityMask & (requiredMask | excludedMask)) == requiredMask)
+			{
+				expectedEntities.push_back(entity);
+			}
+			if (requiredMask != 0 && (entityMask & requiredMask) == requiredMask)
+			{
+				expectedQueryEntities.push_back(entity);
+			}
+		}
+		entityManager->FindEntities(requiredMask, excludedMask, foundEntities);
+		EXPECT_EQ(expectedEntities, foundEntities);
+		if (requiredMask != 0)
+		{
+			auto queryEntities = entityManager->GetQuery(requiredMask).GetEntities();
+			std::sort(queryEntities.begin(), queryEntities.end(), [](Entity entity1, Entity entity2)
+			{
+				return GetEntityIndex(entity1) < GetEntityIndex(entity2);
+			});
+			EXPECT_EQ(expectedQueryEntities, queryEntities);
+		}
+	}
+	engine.Destroy();
+}
+
+TEST(EntityManager, TestFindEntities)
+{
+	//Sizes that leave a tail after the 2 and 4 masks wide loops
+	CheckFindEntities(7);
+	CheckFindEntities(1021);
+	CheckFindEntities(1027);
+}
@@ -0,0 +1,161 @@
+/*
+MIT License
+
+Copyright (c) 2017 SAE Institute Switzerland AG
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <gtest/gtest.h>
+#include <numeric>
+#include <vector>
+
+#include <engine/job_system.h>
+
+TEST(JobSystem, TestParallelFor)
+{
+	sfge::JobSystem jobSystem;
+	jobSystem.Init(3);
+	std::vector<int> values(100000, 0);
+	jobSystem.ParallelFor(0, values.size(), 1024, [&values](size_t start, size_t end)
+	{
+		for (auto i = start; i < end; i++)
+		{
+			values[i] += static_cast<int>(i % 7);
+		}
+	});
+	long long expectedSum = 0;
+	for (size_t i = 0; i < values.size(); i++)
+	{
+		expectedSum += i % 7;
+	}
+	EXPECT_EQ(expectedSum, std::accumulate(values.begin(), values.end(), 0LL));
+	jobSystem.Destroy();
+}
+
+TEST(JobSystem, TestNestedJobs)
+{
+	sfge::JobSystem jobSystem;
+	jobSystem.Init(3);
+	std::atomic<int> jobNmb{0};
+	sfge::JobCounter counter;
+	for (int i = 0; i < 64; i++)
+	{
+		jobSystem.Schedule([&jobSystem, &jobNmb]
+		{
+			sfge::JobCounter childCounter;
+			for (int j = 0; j < 16; j++)
+			{
+				jobSystem.Schedule([&jobNmb]
+				{
+					jobNmb++;
+				}, &childCounter);
+			}
+			jobSystem.Wait(childCounter);
+		}, &counter);
+	}
+	jobSystem.Wait(counter);
+	EXPECT_EQ(64 * 16, jobNmb.load());
+	jobSystem.Destroy();
+}
+
+TEST(JobSystem, TestParallelForEachComponent)
+{
+	struct Component
+	{
+		float value = 0.0f;
+		unsigned index = 0;
+	};
+	sfge::JobSystem jobSystem;
+	jobSystem.Init(3);
+	std::vector<Component> components(10000);
+	jobSystem.ParallelForEachComponent(components, [](size_t i, Component& component)
+	{
+		component.value += 1.0f;
+		component.index = static_cast<unsigned>(i);
+	});
+	for (size_t i = 0; i < components.size(); i++)
+	{
+		EXPECT_EQ(1.0f, components[i].value);
+		EXPECT_EQ(i, components[i].index);
+	}
+	jobSystem.Destroy();
+}
+
+TEST(JobSystem, TestJobRingOverflow)
+{
+	sfge::JobSystem jobSystem;
+	jobSystem.Init(3);
+	//More jobs in flight than the ring holds, the old slots are only reused once their job is done
+	const int jobNmb = 10000;
+	std::vector<int> values(jobNmb, 0);
+	sfge::JobCounter counter;
+	for (int i = 0; i < jobNmb; i++)
+	{
+		jobSystem.Schedule([&values, i]
+		{
+			values[i] = i;
+		}, &counter);
+	}
+	jobSystem.Wait(counter);
+	for (int i = 0; i < jobNmb; i++)
+	{
+		EXPECT_EQ(i, values[i]);
+	}
+	jobSystem.Destroy();
+}
+
+TEST(JobSystem, TestIsWorkerThread)
+{
+	sfge::JobSystem jobSystem;
+	jobSystem.Init(2);
+	EXPECT_TRUE(jobSystem.IsWorkerThread());
+	std::atomic<int> workerJobNmb{0};
+	sfge::JobCounter counter;
+	for (int i = 0; i < 64; i++)
+	{
+		jobSystem.Schedule([&jobSystem, &workerJobNmb]
+		{
+			if (jobSystem.IsWorkerThread())
+			{
+				workerJobNmb++;
+			}
+		}, &counter);
+	}
+	jobSystem.Wait(counter);
+	EXPECT_EQ(64, workerJobNmb.load());
+	bool foreignIsWorker = true;
+	bool foreignJobInline = false;
+	std::thread foreignThread([&jobSystem, &foreignIsWorker, &foreignJobInline]
+	{
+		foreignIsWorker = jobSystem.IsWorkerThread();
+		//A thread without worker runs its jobs before Schedule returns
+		const auto threadId = std::this_thread::get_id();
+		sfge::JobCounter foreignCounter;
+		jobSystem.Schedule([&foreignJobInline, threadId]
+		{
+			foreignJobInline = std::this_thread::get_id() == threadId;
+		}, &foreignCounter);
+		jobSystem.Wait(foreignCounter);
+	});
+	foreignThread.join();
+	EXPECT_FALSE(foreignIsWorker);
+	EXPECT_TRUE(foreignJobInline);
+	jobSystem.Destroy();
+}
@@ -24,6 +24,14 @@ SOFTWARE.
 
 #include <gtest/gtest.h>
 #include <iostream>
+#include <vector>
+#include <string>
+#include <unordered_map>
+#include <memory_resource>
+#include <cstring>
+#include <thread>
+#include <atomic>
+#include <random>
 
 #include <engine/memory.h>
 
@@ -49,3 +57,206 @@ TEST(Memory, TestCustomAllocator)
 
 }
 
+
+TEST(Memory, TestStlAllocator)
+{
+    void* data = malloc(4096);
+    sfge::LinearAllocator linearAllocator(4096, data);
+    {
+        std::vector<int, sfge::StlAllocator<int>> values{sfge::StlAllocator<int>(linearAllocator)};
+        values.reserve(100);
+        for(int i = 0; i < 100; i++)
+        {
+            values.push_back(i);
+        }
+        EXPECT_EQ(values[99], 99);
+        EXPECT_GE(linearAllocator.getUsedMemory(), 100 * sizeof(int));
+    }
+    linearAllocator.clear();
+    EXPECT_EQ(linearAllocator.getUsedMemory(), 0u);
+    free(data);
+}
+
+TEST(Memory, TestAllocatorResource)
+{
+    const size_t size = 64 * 1024;
+    void* data = malloc(size);
+    {
+        sfge::FreeListAllocator freeListAllocator(size, data);
+        sfge::AllocatorResource resource(freeListAllocator);
+        {
+            std::pmr::vector<std::pmr::string> names(&resource);
+            for(int i = 0; i < 100; i++)
+            {
+                names.emplace_back("Entity with a name longer than the small string buffer " + std::to_string(i));
+            }
+            EXPECT_EQ(names[42].get_allocator().resource(), &resource);
+
+            using IndexAllocator = sfge::StlAllocator<std::pair<const int, int>>;
+            std::unordered_map<int, int, std::hash<int>, std::equal_to<int>, IndexAllocator> indexes{
+                    IndexAllocator(freeListAllocator)};
+            for(int i = 0; i < 100; i++)
+            {
+                indexes[i] = i * 2;
+            }
+            EXPECT_EQ(indexes[50], 100);
+            EXPECT_GT(freeListAllocator.getNumAllocations(), 0u);
+        }
+        EXPECT_EQ(freeListAllocator.getNumAllocations(), 0u);
+        EXPECT_EQ(freeListAllocator.getUsedMemory(), 0u);
+    }
+    free(data);
+}
+
+TEST(Memory, TestAllocatorResourceAlignment)
+{
+    const size_t size = 64 * 1024;
+    void* data = malloc(size);
+    {
+        sfge::FreeListAllocator freeListAllocator(size, data);
+        sfge::AllocatorResource resource(freeListAllocator);
+        std::vector<std::pair<void*, size_t>> blocks;
+        //Odd sizes with the alignment of chars would leave the next headers misaligned
+        for(size_t bytes = 1; bytes < 200; bytes += 7)
+        {
+            void* p = resource.allocate(bytes, 1);
+            EXPECT_EQ(reinterpret_cast<uintptr_t>(p) % alignof(std::max_align_t), 0u);
+            std::memset(p, 0xFF, bytes);
+            blocks.emplace_back(p, bytes);
+        }
+        for(size_t i = 0; i < blocks.size(); i += 2)
+        {
+            resource.deallocate(blocks[i].first, blocks[i].second, 1);
+        }
+        for(size_t i = 1; i < blocks.size(); i += 2)
+        {
+            resource.deallocate(blocks[i].first, blocks[i].second, 1);
+        }
+        EXPECT_EQ(freeListAllocator.getNumAllocations(), 0u);
+        EXPECT_EQ(freeListAllocator.getUsedMemory(), 0u);
+    }
+    free(data);
+}
+
+TEST(Memory, TestTlsfAllocator)
+{
+    const size_t size = 1024 * 1024;
+    void* data = malloc(size);
+    {
+        sfge::TlsfAllocator tlsfAllocator(size, data);
+        struct Allocation { unsigned char* p; size_t size; unsigned char value; };
+        std::vector<Allocation> allocations;
+        srand(42);
+        for(int i = 0; i < 10000; i++)
+        {
+            if(!allocations.empty() && rand() % 3 == 0)
+            {
+                const size_t index = rand() % allocations.size();
+                const auto allocation = allocations[index];
+                for(size_t j = 0; j < allocation.size; j++)
+                {
+                    ASSERT_EQ(allocation.p[j], allocation.value);
+                }
+                tlsfAllocator.deallocate(allocation.p);
+                allocations[index] = allocations.back();
+                allocations.pop_back();
+                continue;
+            }
+            const size_t allocationSize = 1 + rand() % 2048;
+            const ptr_type alignment = ptr_type(1) << (rand() % 8);
+            auto* p = static_cast<unsigned char*>(tlsfAllocator.allocate(allocationSize, alignment));
+            if(p == nullptr)
+            {
+                continue;
+            }
+            EXPECT_EQ(reinterpret_cast<ptr_type>(p) % alignment, 0);
+            const auto value = static_cast<unsigned char>(i);
+            memset(p, value, allocationSize);
+            allocations.push_back({p, allocationSize, value});
+        }
+        for(const auto& allocation : allocations)
+        {
+            tlsfAllocator.deallocate(allocation.p);
+        }
+        EXPECT_EQ(tlsfAllocator.getNumAllocations(), 0u);
+        EXPECT_EQ(tlsfAllocator.getUsedMemory(), 0u);
+        //Every free block was merged back, the search rounds up to the next size class so half is the largest sure fit
+        void* p = tlsfAllocator.allocate(size / 2, 8);
+        EXPECT_NE(p, nullptr);
+        tlsfAllocator.deallocate(p);
+    }
+    free(data);
+}
+
+TEST(Memory, TestConcurrentPoolAllocator)
+{
+    const size_t objectNmb = 1024;
+    const size_t threadNmb = 4;
+    void* data = malloc(objectNmb * sizeof(size_t));
+    {
+        sfge::ConcurrentPoolAllocator poolAllocator(sizeof(size_t), alignof(size_t), objectNmb * sizeof(size_t), data, threadNmb);
+        EXPECT_EQ(poolAllocator.getObjectNmb(), objectNmb);
+        std::vector<std::thread> threads;
+        std::atomic<bool> overlap{false};
+        for(size_t threadIndex = 0; threadIndex < threadNmb; threadIndex++)
+        {
+            threads.emplace_back([&poolAllocator, &overlap, threadIndex]
+            {
+                std::mt19937 generator(static_cast<unsigned>(threadIndex));
+                std::vector<size_t*> objects;
+                for(size_t i = 0; i < 20000; i++)
+                {
+                    //Half of the objects go through the caches, the other half straight to the global free list
+                    const bool cached = i % 2 == 0;
+                    if(objects.size() < 200 && (objects.empty() || generator() % 2 == 0))
+                    {
+                        auto* object = static_cast<size_t*>(cached ?
+                                poolAllocator.allocate(threadIndex) : poolAllocator.allocate(sizeof(size_t), alignof(size_t)));
+                        if(object != nullptr)
+                        {
+                            *object = threadIndex;
+                            objects.push_back(object);
+                        }
+                        continue;
+                    }
+                    auto* object = objects.back();
+                    objects.pop_back();
+                    if(*object != threadIndex)
+                    {
+                        overlap = true;
+                    }
+                    if(cached)
+                        poolAllocator.deallocate(object, threadIndex);
+                    else
+                        poolAllocator.deallocate(object);
+                }
+                for(auto* object : objects)
+                {
+                    poolAllocator.deallocate(object, threadIndex);
+                }
+            });
+        }
+        for(auto& thread : threads)
+        {
+            thread.join();
+        }
+        EXPECT_FALSE(overlap);
+        EXPECT_EQ(poolAllocator.getAllocatedObjectNmb(), 0u);
+        poolAllocator.flushCaches();
+        EXPECT_EQ(poolAllocator.getNumAllocations(), 0u);
+        //Every object is back in the global free list
+        std::vector<void*> objects;
+        while(void* object = poolAllocator.allocate(sizeof(size_t), alignof(size_t)))
+        {
+            objects.push_back(object);
+        }
+        EXPECT_EQ(objects.size(), objectNmb);
+        EXPECT_EQ(poolAllocator.getNumAllocations(), objectNmb);
+        EXPECT_EQ(poolAllocator.getUsedMemory(), objectNmb * sizeof(size_t));
+        for(auto* object : objects)
+        {
+            poolAllocator.deallocate(object);
+        }
+    }
+    free(data);
+}
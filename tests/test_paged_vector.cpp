@@ -0,0 +1,84 @@
+/*
+MIT License
+
+Copyright (c) 2017 SAE Institute Switzerland AG
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <gtest/gtest.h>
+#include <string>
+
+#include <engine/paged_vector.h>
+#include <engine/component_storage.h>
+
+TEST(PagedVector, TestStableAddresses)
+{
+	sfge::PagedVector<std::string, 16> strings;
+	strings.push_back("first");
+	auto* first = &strings[0];
+	strings.resize(1000);
+	EXPECT_EQ(first, &strings[0]);
+	EXPECT_EQ(*first, "first");
+	EXPECT_EQ(strings.size(), 1000u);
+	EXPECT_EQ(strings.capacity() % 16, 0u);
+
+	for (size_t i = 1; i < strings.size(); i++)
+	{
+		strings[i] = std::to_string(i);
+	}
+	size_t count = 0;
+	for (auto& string : strings)
+	{
+		if (count > 0)
+		{
+			EXPECT_EQ(string, std::to_string(count));
+		}
+		count++;
+	}
+	EXPECT_EQ(count, 1000u);
+	strings.resize(10);
+	EXPECT_EQ(strings.back(), "9");
+	strings.clear();
+	EXPECT_TRUE(strings.empty());
+}
+
+TEST(PagedVector, TestComponentStorage)
+{
+	sfge::JobSystem jobSystem;
+	jobSystem.Init(3);
+	sfge::ComponentStorage<float> components;
+	components.ResizeEntityNmb(10);
+	auto* firstComponent = components.Insert(1);
+	*firstComponent = 1.0f;
+	for (Entity entity = 2; entity <= 5000; entity++)
+	{
+		*components.Insert(entity) = static_cast<float>(entity);
+	}
+	EXPECT_EQ(firstComponent, components.Get(1));
+	components.ParallelForEach(jobSystem, [](Entity entity, float& component)
+	{
+		component += static_cast<float>(entity);
+	});
+	components.ForEach([](Entity entity, float& component)
+	{
+		EXPECT_EQ(component, entity * 2.0f);
+	});
+	jobSystem.Destroy();
+}
@@ -23,9 +23,14 @@ SOFTWARE.
 */
 #include <engine/engine.h>
 #include <engine/scene.h>
+#include <engine/config.h>
+#include <engine/entity.h>
+#include <engine/transform2d.h>
 #include <gtest/gtest.h>
 #include "graphics/shape2d.h"
 #include "physics/collider2d.h"
+#include "physics/body2d.h"
+#include "physics/physics2d.h"
 
 TEST(Physics, TestBallFallingToGround)
 {
@@ -197,4 +202,87 @@ TEST(Physics, TestShapeContact)
 	);
 	sceneManager->LoadSceneFromJson(sceneJson);
 	engine.Start();
-}
\ No newline at end of file
+}
+
+TEST(Physics, TestHeadlessBallFalling)
+{
+	sfge::Engine engine;
+	auto config = std::make_unique<sfge::Configuration>();
+	config->devMode = false;
+	config->editor = false;
+	config->windowLess = true;
+	engine.Init(std::move(config));
+
+	json sceneJson;
+	sceneJson["name"] = "Headless Ball Falling";
+
+	json entityJson;
+	entityJson["name"] = "Ball";
+
+	json transformJson;
+	transformJson["type"] = sfge::ComponentType::TRANSFORM2D;
+	transformJson["position"] = { 300,300 };
+
+	json rigidBodyJson;
+	rigidBodyJson["name"] = "Rigidbody";
+	rigidBodyJson["type"] = sfge::ComponentType::BODY2D;
+	rigidBodyJson["body_type"] = b2_dynamicBody;
+
+	entityJson["components"] = { transformJson, rigidBodyJson };
+	sceneJson["entities"] = { entityJson };
+	engine.GetSceneManager()->LoadSceneFromJson(sceneJson);
+
+	const auto ball = engine.GetEntityManager()->GetEntityByName("Ball");
+	ASSERT_NE(ball, INVALID_ENTITY);
+	auto* transformManager = engine.GetTransform2dManager();
+	const auto startPosition = transformManager->GetComponentPtr(ball)->Position;
+
+	//Ticking by hand instead of Start keeps the managers alive until the checks are done
+	for (int tick = 0; tick < 50; tick++)
+	{
+		engine.HeadlessTick();
+	}
+	const auto* transform = transformManager->GetComponentPtr(ball);
+	ASSERT_NE(transform, nullptr);
+	EXPECT_GT(transform->Position.y, startPosition.y);
+	engine.Destroy();
+}
+
+TEST(Physics, TestFixedUpdateAccumulator)
+{
+	sfge::Engine engine;
+	auto config = std::make_unique<sfge::Configuration>();
+	config->devMode = false;
+	config->editor = false;
+	config->windowLess = true;
+	//Binary fractions keep the accumulator exact
+	config->fixedDeltaTime = 0.25f;
+	config->maxFixedUpdatesPerFrame = 5;
+	engine.Init(std::move(config));
+
+	auto* entityManager = engine.GetEntityManager();
+	auto* transformManager = engine.GetTransform2dManager();
+	const auto ball = entityManager->CreateEntity(INVALID_ENTITY);
+	transformManager->AddComponent(ball)->Position = sf::Vector2f(300.0f, 300.0f);
+	ASSERT_NE(nullptr, engine.GetPhysicsManager()->GetBodyManager()->AddComponent(ball));
+	auto lastPosition = transformManager->GetComponentPtr(ball)->Position;
+
+	//Less than a fixed step only accumulates, the physics does not move
+	EXPECT_EQ(0u, engine.RunFixedUpdates(0.125f));
+	EXPECT_FLOAT_EQ(0.5f, engine.GetFixedUpdateAlpha());
+	EXPECT_EQ(lastPosition, transformManager->GetComponentPtr(ball)->Position);
+
+	//Catching up runs one step per full fixed step accumulated
+	EXPECT_EQ(2u, engine.RunFixedUpdates(0.5f));
+	EXPECT_FLOAT_EQ(0.5f, engine.GetFixedUpdateAlpha());
+	EXPECT_GT(transformManager->GetComponentPtr(ball)->Position.y, lastPosition.y);
+
+	//A long frame is clamped to maxFixedUpdatesPerFrame steps and its extra time is dropped
+	EXPECT_EQ(5u, engine.RunFixedUpdates(10.0f));
+	EXPECT_FLOAT_EQ(0.0f, engine.GetFixedUpdateAlpha());
+	EXPECT_EQ(0u, engine.RunFixedUpdates(0.1875f));
+	EXPECT_FLOAT_EQ(0.75f, engine.GetFixedUpdateAlpha());
+	EXPECT_EQ(1u, engine.RunFixedUpdates(0.125f));
+	EXPECT_FLOAT_EQ(0.25f, engine.GetFixedUpdateAlpha());
+	engine.Destroy();
+}
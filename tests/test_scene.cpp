@@ -22,10 +22,18 @@ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
 SOFTWARE.
 */
 
+#include <engine/config.h>
 #include <engine/engine.h>
+#include <engine/entity.h>
 #include <engine/scene.h>
+#include <engine/transform2d.h>
+#include <graphics/graphics2d.h>
+#include <graphics/sprite2d.h>
 #include <utility/json_utility.h>
 #include <gtest/gtest.h>
+#include <algorithm>
+#include <set>
+#include <vector>
 
 TEST(Scene, TestSwitchScene)
 {
@@ -58,4 +66,122 @@ TEST(Scene, TestSwitchSceneLeak)
 
 
 
-}
\ No newline at end of file
+}
+
+TEST(Scene, TestInstantiatePrefab)
+{
+	sfge::Engine engine;
+	auto config = std::make_unique<sfge::Configuration>();
+	config->devMode = false;
+	config->editor = false;
+	config->windowLess = true;
+	engine.Init(std::move(config));
+
+	auto* sceneManager = engine.GetSceneManager();
+	auto* entityManager = engine.GetEntityManager();
+	auto* transformManager = engine.GetTransform2dManager();
+	auto* spriteManager = engine.GetGraphics2dManager()->GetSpriteManager();
+
+	json prefabJson;
+	prefabJson["name"] = "Planet";
+	json transformJson;
+	transformJson["type"] = static_cast<int>(sfge::ComponentType::TRANSFORM2D);
+	transformJson["position"] = {100, 200};
+	transformJson["scale"] = {2.0, 0.5};
+	transformJson["angle"] = 45.0;
+	json spriteJson;
+	spriteJson["type"] = static_cast<int>(sfge::ComponentType::SPRITE2D);
+	spriteJson["path"] = "data/sprites/round.png";
+	prefabJson["components"] = {transformJson, spriteJson};
+	auto prefab = sceneManager->CompilePrefab(prefabJson);
+	ASSERT_EQ(2u, prefab.components.size());
+
+	const size_t entityNmb = 100;
+	size_t initializedNmb = 0;
+	const auto entities = sceneManager->InstantiatePrefab(prefab, entityNmb, [&initializedNmb](Entity, size_t)
+	{
+		initializedNmb++;
+	});
+	ASSERT_EQ(entityNmb, entities.size());
+	EXPECT_EQ(entityNmb, initializedNmb);
+
+	const auto mask = static_cast<sfge::EntityMask>(sfge::ComponentType::TRANSFORM2D) |
+		static_cast<sfge::EntityMask>(sfge::ComponentType::SPRITE2D);
+	const auto* firstSpriteInfo = spriteManager->GetComponentInfo(entities.front());
+	ASSERT_NE(nullptr, firstSpriteInfo);
+	EXPECT_NE(sfge::INVALID_TEXTURE, firstSpriteInfo->textureId);
+	for (auto entity : entities)
+	{
+		EXPECT_TRUE(entityManager->IsEntityValid(entity));
+		EXPECT_EQ(mask, entityManager->GetMask(entity));
+		EXPECT_EQ("Planet", entityManager->GetEntityInfo(entity)->name);
+
+		const auto* transform = transformManager->GetComponentPtr(entity);
+		ASSERT_NE(nullptr, transform);
+		EXPECT_EQ(sf::Vector2f(100.0f, 200.0f), transform->Position);
+		EXPECT_EQ(sf::Vector2f(2.0f, 0.5f), transform->Scale);
+		EXPECT_FLOAT_EQ(45.0f, transform->EulerAngle);
+
+		//All the copies share the texture loaded for the first sprite
+		EXPECT_NE(nullptr, spriteManager->GetComponentPtr(entity));
+		auto* spriteInfo = spriteManager->GetComponentInfo(entity);
+		ASSERT_NE(nullptr, spriteInfo);
+		EXPECT_EQ(firstSpriteInfo->textureId, spriteInfo->textureId);
+		EXPECT_EQ(firstSpriteInfo->texturePath, spriteInfo->texturePath);
+		EXPECT_EQ(entity, spriteInfo->GetEntity());
+	}
+	EXPECT_EQ(entityNmb, transformManager->GetComponents().Size());
+	EXPECT_EQ(entityNmb, spriteManager->GetComponents().Size());
+	EXPECT_EQ(entityNmb, entityManager->GetQuery(mask).Size());
+
+	engine.Destroy();
+}
+
+TEST(Scene, TestCreateEntities)
+{
+	sfge::Engine engine;
+	auto config = std::make_unique<sfge::Configuration>();
+	config->devMode = false;
+	config->editor = false;
+	config->windowLess = true;
+	engine.Init(std::move(config));
+
+	auto* entityManager = engine.GetEntityManager();
+	const size_t entityNmb = INIT_ENTITY_NMB / 4;
+	const auto entities = entityManager->CreateEntities(entityNmb);
+	ASSERT_EQ(entityNmb, entities.size());
+	std::set<size_t> entityIndexes;
+	for (auto entity : entities)
+	{
+		EXPECT_TRUE(entityManager->IsEntityValid(entity));
+		EXPECT_EQ(sfge::EntityMask(0), entityManager->GetMask(entity));
+		entityIndexes.insert(GetEntityIndex(entity));
+	}
+	EXPECT_EQ(entityNmb, entityIndexes.size());
+
+	//Only the free entities are returned when there are not enough of them
+	const auto otherEntities = entityManager->CreateEntities(INIT_ENTITY_NMB);
+	EXPECT_LT(otherEntities.size(), size_t(INIT_ENTITY_NMB));
+	for (auto entity : otherEntities)
+	{
+		EXPECT_EQ(0u, entityIndexes.count(GetEntityIndex(entity)));
+	}
+	EXPECT_TRUE(entityManager->CreateEntities(1).empty());
+
+	//The destroyed entities are given back with a new version
+	const std::vector<Entity> destroyedEntities(entities.begin(), entities.begin() + 3);
+	entityManager->DestroyEntities(destroyedEntities);
+	const auto reusedEntities = entityManager->CreateEntities(5);
+	ASSERT_EQ(destroyedEntities.size(), reusedEntities.size());
+	for (auto entity : reusedEntities)
+	{
+		EXPECT_EQ(1u, entityIndexes.count(GetEntityIndex(entity)));
+		EXPECT_TRUE(std::find(destroyedEntities.begin(), destroyedEntities.end(), entity) == destroyedEntities.end());
+	}
+	for (auto entity : destroyedEntities)
+	{
+		EXPECT_FALSE(entityManager->IsEntityValid(entity));
+	}
+
+	engine.Destroy();
+}
@@ -0,0 +1,114 @@
+/*
+MIT License
+
+Copyright (c) 2017 SAE Institute Switzerland AG
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+#include <gtest/gtest.h>
+#include <cstdint>
+
+#include <engine/config.h>
+#include <engine/engine.h>
+#include <engine/entity.h>
+#include <engine/snapshot.h>
+#include <engine/transform2d.h>
+#include <physics/body2d.h>
+#include <physics/physics2d.h>
+
+TEST(Snapshot, TestWriteRead)
+{
+	sfge::Snapshot snapshot;
+	snapshot.Write<char>('a');
+	const double values[] = { 1.0, 2.0, 3.0 };
+	snapshot.WriteArray(values, 3);
+	snapshot.Write<int>(42);
+
+	snapshot.Rewind();
+	EXPECT_EQ(snapshot.Read<char>(), 'a');
+	size_t count = 0;
+	const auto* readValues = snapshot.ReadArray<double>(count);
+	ASSERT_EQ(count, 3u);
+	EXPECT_EQ(reinterpret_cast<uintptr_t>(readValues) % alignof(double), 0u);
+	EXPECT_EQ(readValues[2], 3.0);
+	EXPECT_EQ(snapshot.Read<int>(), 42);
+	EXPECT_EQ(snapshot.ReadArray<int>(count), nullptr);
+	EXPECT_EQ(count, 0u);
+
+	snapshot.Clear();
+	EXPECT_TRUE(snapshot.IsEmpty());
+}
+
+TEST(Snapshot, TestEngineRoundTrip)
+{
+	sfge::Engine engine;
+	auto config = std::make_unique<sfge::Configuration>();
+	config->devMode = false;
+	config->editor = false;
+	config->windowLess = true;
+	engine.Init(std::move(config));
+
+	auto* entityManager = engine.GetEntityManager();
+	auto* transformManager = engine.GetTransform2dManager();
+	auto* bodyManager = engine.GetPhysicsManager()->GetBodyManager();
+	const auto entity = entityManager->CreateEntity(INVALID_ENTITY);
+	transformManager->AddComponent(entity)->Position = sf::Vector2f(100.0f, 50.0f);
+	auto* body2d = bodyManager->AddComponent(entity);
+	ASSERT_NE(nullptr, body2d);
+	body2d->SetLinearVelocity(b2Vec2(1.0f, -2.0f));
+	engine.HeadlessTick();
+
+	sfge::Snapshot snapshot;
+	engine.SaveSnapshot(snapshot);
+	const auto savedTransform = *transformManager->GetComponentPtr(entity);
+	auto* body = bodyManager->GetComponentPtr(entity)->GetBody();
+	ASSERT_NE(nullptr, body);
+	const auto savedPosition = body->GetPosition();
+	const auto savedVelocity = body->GetLinearVelocity();
+
+	//Move everything away from the snapshot, and create an entity that did not exist then
+	for (int i = 0; i < 10; i++)
+	{
+		engine.HeadlessTick();
+	}
+	auto* transform = transformManager->GetComponentPtr(entity);
+	transform->Position += sf::Vector2f(30.0f, 30.0f);
+	transform->EulerAngle = 45.0f;
+	body->SetTransform(b2Vec2(-5.0f, -5.0f), 1.0f);
+	body->SetLinearVelocity(b2Vec2(10.0f, 10.0f));
+	const auto newEntity = entityManager->CreateEntity(INVALID_ENTITY);
+	transformManager->AddComponent(newEntity);
+
+	ASSERT_TRUE(engine.RestoreSnapshot(snapshot));
+	transform = transformManager->GetComponentPtr(entity);
+	ASSERT_NE(nullptr, transform);
+	EXPECT_FLOAT_EQ(savedTransform.Position.x, transform->Position.x);
+	EXPECT_FLOAT_EQ(savedTransform.Position.y, transform->Position.y);
+	EXPECT_FLOAT_EQ(savedTransform.EulerAngle, transform->EulerAngle);
+	body = bodyManager->GetComponentPtr(entity)->GetBody();
+	EXPECT_FLOAT_EQ(savedPosition.x, body->GetPosition().x);
+	EXPECT_FLOAT_EQ(savedPosition.y, body->GetPosition().y);
+	EXPECT_FLOAT_EQ(savedVelocity.x, body->GetLinearVelocity().x);
+	EXPECT_FLOAT_EQ(savedVelocity.y, body->GetLinearVelocity().y);
+	EXPECT_FALSE(entityManager->IsEntityValid(newEntity));
+	EXPECT_EQ(nullptr, transformManager->GetComponentPtr(newEntity));
+	engine.Destroy();
+}
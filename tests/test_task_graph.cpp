@@ -0,0 +1,85 @@
+/*
+MIT License
+
+Copyright (c) 2017 SAE Institute Switzerland AG
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#include <gtest/gtest.h>
+#include <atomic>
+
+#include <engine/task_graph.h>
+#include <engine/component.h>
+
+const auto transformMask = static_cast<sfge::EntityMask>(sfge::ComponentType::TRANSFORM2D);
+const auto spriteMask = static_cast<sfge::EntityMask>(sfge::ComponentType::SPRITE2D);
+const auto shapeMask = static_cast<sfge::EntityMask>(sfge::ComponentType::SHAPE2D);
+const auto bodyMask = static_cast<sfge::EntityMask>(sfge::ComponentType::BODY2D);
+
+TEST(TaskGraph, TestConflictingTasksWaves)
+{
+	sfge::TaskGraph taskGraph;
+	const auto writeTransform = taskGraph.AddTask("WriteTransform", []{}, 0, transformMask);
+	const auto readTransform = taskGraph.AddTask("ReadTransform", []{}, transformMask, spriteMask);
+	const auto writeTransformAgain = taskGraph.AddTask("WriteTransformAgain", []{}, bodyMask, transformMask);
+	const auto writeAll = taskGraph.AddTask("WriteAll", []{},
+		sfge::ALL_COMPONENTS_MASK, sfge::ALL_COMPONENTS_MASK, true);
+	taskGraph.Build();
+
+	EXPECT_LT(taskGraph.GetTaskWave(writeTransform), taskGraph.GetTaskWave(readTransform));
+	EXPECT_LT(taskGraph.GetTaskWave(readTransform), taskGraph.GetTaskWave(writeTransformAgain));
+	EXPECT_LT(taskGraph.GetTaskWave(writeTransformAgain), taskGraph.GetTaskWave(writeAll));
+	EXPECT_EQ(4u, taskGraph.GetWaveNmb());
+}
+
+TEST(TaskGraph, TestIndependentTasksShareWave)
+{
+	sfge::TaskGraph taskGraph;
+	const auto writeTransform = taskGraph.AddTask("WriteTransform", []{}, 0, transformMask);
+	const auto writeBody = taskGraph.AddTask("WriteBody", []{}, 0, bodyMask, true);
+	const auto sprite = taskGraph.AddTask("SpriteUpdate", []{}, transformMask, spriteMask);
+	const auto shape = taskGraph.AddTask("ShapeUpdate", []{}, transformMask, shapeMask);
+	taskGraph.Build();
+
+	EXPECT_EQ(taskGraph.GetTaskWave(writeTransform), taskGraph.GetTaskWave(writeBody));
+	EXPECT_EQ(taskGraph.GetTaskWave(sprite), taskGraph.GetTaskWave(shape));
+	EXPECT_LT(taskGraph.GetTaskWave(writeTransform), taskGraph.GetTaskWave(sprite));
+	EXPECT_EQ(2u, taskGraph.GetWaveNmb());
+}
+
+TEST(TaskGraph, TestExecuteOrder)
+{
+	sfge::JobSystem jobSystem;
+	jobSystem.Init(3);
+	sfge::TaskGraph taskGraph;
+	std::atomic<int> transformValue{0};
+	std::atomic<int> spriteValue{0};
+	std::atomic<int> shapeValue{0};
+	taskGraph.AddTask("WriteTransform", [&transformValue]{ transformValue = 1; }, 0, transformMask);
+	taskGraph.AddTask("SpriteUpdate", [&transformValue, &spriteValue]{ spriteValue = transformValue + 1; },
+		transformMask, spriteMask);
+	taskGraph.AddTask("ShapeUpdate", [&transformValue, &shapeValue]{ shapeValue = transformValue + 2; },
+		transformMask, shapeMask, true);
+	taskGraph.Build();
+	taskGraph.Execute(jobSystem);
+
+	EXPECT_EQ(2, spriteValue.load());
+	EXPECT_EQ(3, shapeValue.load());
+	jobSystem.Destroy();
+}
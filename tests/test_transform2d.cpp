@@ -0,0 +1,265 @@
+/*
+MIT License
+
+Copyright (c) 2017 SAE Institute Switzerland AG
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <gtest/gtest.h>
+#include <memory>
+
+#include <engine/config.h>
+#include <engine/engine.h>
+#include <engine/entity.h>
+#include <engine/transform2d.h>
+
+static std::unique_ptr<sfge::Configuration> CreateTestConfig()
+{
+	auto config = std::make_unique<sfge::Configuration>();
+	config->devMode = false;
+	config->editor = false;
+	config->windowLess = true;
+	return config;
+}
+
+static Entity CreateTransformEntity(sfge::Engine& engine, sfge::Vec2f position, float angle = 0.0f)
+{
+	const auto entity = engine.GetEntityManager()->CreateEntity(INVALID_ENTITY);
+	auto* transform = engine.GetTransform2dManager()->AddComponent(entity);
+	transform->Position = position;
+	transform->EulerAngle = angle;
+	return entity;
+}
+
+static void ExpectPosition(sfge::Vec2f expected, sfge::Vec2f position)
+{
+	EXPECT_NEAR(expected.x, position.x, 1e-3f);
+	EXPECT_NEAR(expected.y, position.y, 1e-3f);
+}
+
+TEST(Transform2d, TestDirtyPropagation)
+{
+	sfge::Engine engine;
+	engine.Init(CreateTestConfig());
+	auto* transformManager = engine.GetTransform2dManager();
+
+	const auto parent = CreateTransformEntity(engine, sfge::Vec2f(100.0f, 0.0f));
+	const auto child = CreateTransformEntity(engine, sfge::Vec2f(10.0f, 0.0f));
+	const auto grandChild = CreateTransformEntity(engine, sfge::Vec2f(0.0f, 5.0f));
+	const auto otherParent = CreateTransformEntity(engine, sfge::Vec2f(0.0f, 200.0f));
+	const auto otherChild = CreateTransformEntity(engine, sfge::Vec2f(1.0f, 1.0f));
+	ASSERT_TRUE(transformManager->SetParent(child, parent));
+	ASSERT_TRUE(transformManager->SetParent(grandChild, child));
+	ASSERT_TRUE(transformManager->SetParent(otherChild, otherParent));
+	transformManager->OnUpdate(0.0f);
+	ExpectPosition(sfge::Vec2f(110.0f, 0.0f), transformManager->GetWorldTransform(child).Position);
+	ExpectPosition(sfge::Vec2f(110.0f, 5.0f), transformManager->GetWorldTransform(grandChild).Position);
+	ExpectPosition(sfge::Vec2f(1.0f, 201.0f), transformManager->GetWorldTransform(otherChild).Position);
+
+	//Nothing moved, no world transform is marked as changed
+	transformManager->OnUpdate(0.0f);
+	const auto staticVersion = transformManager->GetFrameVersion();
+	EXPECT_NE(staticVersion, transformManager->GetChangeVersion(child));
+	EXPECT_NE(staticVersion, transformManager->GetChangeVersion(grandChild));
+
+	//Rotating the parent moves its whole subtree, the other hierarchy is not touched
+	transformManager->GetComponentPtr(parent)->EulerAngle = 90.0f;
+	transformManager->OnUpdate(0.0f);
+	const auto frameVersion = transformManager->GetFrameVersion();
+	EXPECT_EQ(frameVersion, transformManager->GetChangeVersion(child));
+	EXPECT_EQ(frameVersion, transformManager->GetChangeVersion(grandChild));
+	EXPECT_NE(frameVersion, transformManager->GetChangeVersion(otherChild));
+	ExpectPosition(sfge::Vec2f(100.0f, 10.0f), transformManager->GetWorldTransform(child).Position);
+	ExpectPosition(sfge::Vec2f(95.0f, 10.0f), transformManager->GetWorldTransform(grandChild).Position);
+	EXPECT_FLOAT_EQ(90.0f, transformManager->GetWorldTransform(grandChild).EulerAngle);
+	ExpectPosition(sfge::Vec2f(1.0f, 201.0f), transformManager->GetWorldTransform(otherChild).Position);
+
+	engine.Destroy();
+}
+
+TEST(Transform2d, TestReparenting)
+{
+	sfge::Engine engine;
+	engine.Init(CreateTestConfig());
+	auto* transformManager = engine.GetTransform2dManager();
+
+	const auto parent = CreateTransformEntity(engine, sfge::Vec2f(100.0f, 0.0f));
+	const auto otherParent = CreateTransformEntity(engine, sfge::Vec2f(0.0f, 200.0f));
+	const auto child = CreateTransformEntity(engine, sfge::Vec2f(10.0f, 0.0f));
+	const auto grandChild = CreateTransformEntity(engine, sfge::Vec2f(0.0f, 5.0f));
+	ASSERT_TRUE(transformManager->SetParent(child, parent));
+	ASSERT_TRUE(transformManager->SetParent(grandChild, child));
+	transformManager->OnUpdate(0.0f);
+	ExpectPosition(sfge::Vec2f(110.0f, 5.0f), transformManager->GetWorldTransform(grandChild).Position);
+
+	//A parent cannot become the child of its descendants
+	EXPECT_FALSE(transformManager->SetParent(parent, grandChild));
+	EXPECT_FALSE(transformManager->SetParent(child, child));
+	EXPECT_EQ(INVALID_ENTITY, transformManager->GetParent(parent));
+
+	//The subtree follows its new parent
+	ASSERT_TRUE(transformManager->SetParent(child, otherParent));
+	EXPECT_EQ(otherParent, transformManager->GetParent(child));
+	transformManager->OnUpdate(0.0f);
+	ExpectPosition(sfge::Vec2f(10.0f, 200.0f), transformManager->GetWorldTransform(child).Position);
+	ExpectPosition(sfge::Vec2f(10.0f, 205.0f), transformManager->GetWorldTransform(grandChild).Position);
+
+	//Detached, the local transform becomes the world transform
+	ASSERT_TRUE(transformManager->SetParent(child, INVALID_ENTITY));
+	transformManager->OnUpdate(0.0f);
+	ExpectPosition(sfge::Vec2f(10.0f, 0.0f), transformManager->GetWorldTransform(child).Position);
+	ExpectPosition(sfge::Vec2f(10.0f, 5.0f), transformManager->GetWorldTransform(grandChild).Position);
+
+	engine.Destroy();
+}
+
+TEST(Transform2d, TestDepthOrder)
+{
+	sfge::Engine engine;
+	engine.Init(CreateTestConfig());
+	auto* transformManager = engine.GetTransform2dManager();
+
+	//The children are created before their parents, they are still updated after them
+	const auto grandChild = CreateTransformEntity(engine, sfge::Vec2f(1.0f, 0.0f));
+	const auto child = CreateTransformEntity(engine, sfge::Vec2f(10.0f, 0.0f));
+	const auto parent = CreateTransformEntity(engine, sfge::Vec2f(100.0f, 0.0f));
+	ASSERT_TRUE(transformManager->SetParent(grandChild, child));
+	ASSERT_TRUE(transformManager->SetParent(child, parent));
+	transformManager->OnUpdate(0.0f);
+	ExpectPosition(sfge::Vec2f(110.0f, 0.0f), transformManager->GetWorldTransform(child).Position);
+	ExpectPosition(sfge::Vec2f(111.0f, 0.0f), transformManager->GetWorldTransform(grandChild).Position);
+
+	transformManager->GetComponentPtr(parent)->Position = sfge::Vec2f(0.0f, 0.0f);
+	transformManager->OnUpdate(0.0f);
+	ExpectPosition(sfge::Vec2f(11.0f, 0.0f), transformManager->GetWorldTransform(grandChild).Position);
+
+	engine.Destroy();
+}
+
+TEST(Transform2d, TestDestroyParent)
+{
+	sfge::Engine engine;
+	engine.Init(CreateTestConfig());
+	auto* entityManager = engine.GetEntityManager();
+	auto* transformManager = engine.GetTransform2dManager();
+
+	const auto parent = CreateTransformEntity(engine, sfge::Vec2f(100.0f, 0.0f));
+	const auto child = CreateTransformEntity(engine, sfge::Vec2f(10.0f, 0.0f));
+	const auto grandChild = CreateTransformEntity(engine, sfge::Vec2f(0.0f, 5.0f));
+	ASSERT_TRUE(transformManager->SetParent(child, parent));
+	ASSERT_TRUE(transformManager->SetParent(grandChild, child));
+	transformManager->OnUpdate(0.0f);
+
+	//The children of the destroyed entity become roots and keep their local transform
+	entityManager->DestroyEntity(parent);
+	EXPECT_EQ(INVALID_ENTITY, transformManager->GetParent(child));
+	EXPECT_EQ(child, transformManager->GetParent(grandChild));
+	transformManager->OnUpdate(0.0f);
+	ExpectPosition(sfge::Vec2f(10.0f, 0.0f), transformManager->GetWorldTransform(child).Position);
+	ExpectPosition(sfge::Vec2f(10.0f, 5.0f), transformManager->GetWorldTransform(grandChild).Position);
+
+	//The index of the parent is reused by an entity outside the hierarchy
+	const auto newEntity = CreateTransformEntity(engine, sfge::Vec2f(50.0f, 50.0f));
+	EXPECT_EQ(INVALID_ENTITY, transformManager->GetParent(newEntity));
+	transformManager->OnUpdate(0.0f);
+	ExpectPosition(sfge::Vec2f(10.0f, 5.0f), transformManager->GetWorldTransform(grandChild).Position);
+
+	engine.Destroy();
+}
+
+TEST(Transform2d, TestInterpolatedChildren)
+{
+	sfge::Engine engine;
+	engine.Init(CreateTestConfig());
+	auto* transformManager = engine.GetTransform2dManager();
+
+	const auto parent = CreateTransformEntity(engine, sfge::Vec2f(100.0f, 0.0f));
+	const auto child = CreateTransformEntity(engine, sfge::Vec2f(10.0f, 0.0f));
+	ASSERT_TRUE(transformManager->SetParent(child, parent));
+	transformManager->OnUpdate(0.0f);
+
+	//The parent moves and turns during the fixed update, the child is drawn halfway like its parent
+	transformManager->StorePreviousTransforms();
+	auto* parentTransform = transformManager->GetComponentPtr(parent);
+	parentTransform->Position = sfge::Vec2f(200.0f, 0.0f);
+	parentTransform->EulerAngle = 90.0f;
+	transformManager->OnUpdate(0.0f);
+
+	const auto interpolatedParent = transformManager->GetInterpolatedWorldTransform(parent, 0.5f);
+	ExpectPosition(sfge::Vec2f(150.0f, 0.0f), interpolatedParent.Position);
+	EXPECT_FLOAT_EQ(45.0f, interpolatedParent.EulerAngle);
+	const auto interpolatedChild = transformManager->GetInterpolatedWorldTransform(child, 0.5f);
+	const float halfSqrt2 = 0.70710678f;
+	ExpectPosition(sfge::Vec2f(150.0f + 10.0f * halfSqrt2, 10.0f * halfSqrt2), interpolatedChild.Position);
+	EXPECT_FLOAT_EQ(45.0f, interpolatedChild.EulerAngle);
+
+	//At the end of the step, it is the world transform of the hierarchy
+	const auto currentChild = transformManager->GetInterpolatedWorldTransform(child, 1.0f);
+	ExpectPosition(transformManager->GetWorldTransform(child).Position, currentChild.Position);
+	EXPECT_FLOAT_EQ(transformManager->GetWorldTransform(child).EulerAngle, currentChild.EulerAngle);
+
+	engine.Destroy();
+}
+
+TEST(Transform2d, TestSoAStorage)
+{
+	sfge::Engine engine;
+	auto config = CreateTestConfig();
+	config->transformSoA = true;
+	engine.Init(std::move(config));
+	auto* entityManager = engine.GetEntityManager();
+	auto* transformManager = engine.GetTransform2dManager();
+	auto* transforms = transformManager->GetSoA();
+	ASSERT_NE(nullptr, transforms);
+
+	//The transforms live in the arrays of the manager and are reached through a proxy
+	const auto parent = entityManager->CreateEntity(INVALID_ENTITY);
+	const auto child = entityManager->CreateEntity(INVALID_ENTITY);
+	const auto other = entityManager->CreateEntity(INVALID_ENTITY);
+	for (const auto entity : { parent, child, other })
+	{
+		EXPECT_EQ(nullptr, transformManager->AddComponent(entity));
+		EXPECT_TRUE(transformManager->HasTransform(entity));
+	}
+	EXPECT_EQ(3u, transforms->Size());
+	transformManager->GetComponentRef(parent).SetPosition(sfge::Vec2f(100.0f, 0.0f));
+	transformManager->GetComponentRef(child).SetPosition(sfge::Vec2f(10.0f, 0.0f));
+	transformManager->GetComponentRef(other).SetEulerAngle(270.0f);
+	EXPECT_FLOAT_EQ(100.0f, transforms->positionsX[transformManager->GetSoAIndex(parent)]);
+	ASSERT_TRUE(transformManager->SetParent(child, parent));
+	transformManager->OnUpdate(0.0f);
+	ExpectPosition(sfge::Vec2f(110.0f, 0.0f), transformManager->GetWorldTransform(child).Position);
+	EXPECT_FLOAT_EQ(-90.0f, transformManager->GetLocalTransform(other).EulerAngle);
+
+	//Moving the arrays directly is seen by the hierarchy
+	transforms->positionsY[transformManager->GetSoAIndex(parent)] = 20.0f;
+	transformManager->OnUpdate(0.0f);
+	ExpectPosition(sfge::Vec2f(110.0f, 20.0f), transformManager->GetWorldTransform(child).Position);
+
+	//Removing a transform moves the last one in its slot
+	entityManager->DestroyEntity(parent);
+	EXPECT_FALSE(transformManager->HasTransform(parent));
+	EXPECT_FALSE(transformManager->GetComponentRef(parent).IsValid());
+	EXPECT_EQ(2u, transforms->Size());
+	EXPECT_FLOAT_EQ(-90.0f, transformManager->GetComponentRef(other).GetEulerAngle());
+	ExpectPosition(sfge::Vec2f(10.0f, 0.0f), transformManager->GetComponentRef(child).GetPosition());
+
+	engine.Destroy();
+}
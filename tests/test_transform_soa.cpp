@@ -0,0 +1,73 @@
+/*
+MIT License
+
+Copyright (c) 2017 SAE Institute Switzerland AG
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <gtest/gtest.h>
+
+#include <engine/transform2d.h>
+#include <engine/transform2d_soa.h>
+
+TEST(Transform2dSoA, TestWrapAngles)
+{
+	sfge::Transform2dSoA transforms;
+	const float angles[] = { 0.0f, 190.0f, -190.0f, 180.0f, -180.0f, 359.0f, -359.0f, 45.0f, 181.0f };
+	for (auto angle : angles)
+	{
+		sfge::Transform2d transform;
+		transform.EulerAngle = angle;
+		transforms.Add(INVALID_ENTITY, transform);
+	}
+	transforms.WrapAngles();
+	const float wrappedAngles[] = { 0.0f, -170.0f, 170.0f, 180.0f, -180.0f, -1.0f, 1.0f, 45.0f, -179.0f };
+	for (size_t i = 0; i < transforms.Size(); i++)
+	{
+		EXPECT_FLOAT_EQ(transforms.Get(i).EulerAngle, wrappedAngles[i]);
+	}
+}
+
+TEST(Transform2dSoA, TestIntegrate)
+{
+	sfge::Transform2dSoA transforms;
+	std::vector<float> velocitiesX;
+	std::vector<float> velocitiesY;
+	for (Entity entity = 1; entity <= 11; entity++)
+	{
+		sfge::Transform2d transform;
+		transform.Position = sfge::Vec2f(static_cast<float>(entity), 0.0f);
+		transforms.Add(entity, transform);
+		velocitiesX.push_back(2.0f);
+		velocitiesY.push_back(static_cast<float>(entity));
+	}
+	transforms.Integrate(velocitiesX.data(), velocitiesY.data(), 0.5f);
+	transforms.Translate(sfge::Vec2f(1.0f, -1.0f));
+	for (size_t i = 0; i < transforms.Size(); i++)
+	{
+		const auto entity = transforms.GetEntity(i);
+		EXPECT_FLOAT_EQ(transforms.Get(i).Position.x, entity + 2.0f);
+		EXPECT_FLOAT_EQ(transforms.Get(i).Position.y, entity * 0.5f - 1.0f);
+	}
+	transforms.Remove(0);
+	EXPECT_EQ(transforms.Size(), 10u);
+	EXPECT_EQ(transforms.GetEntity(0), 11u);
+	EXPECT_FLOAT_EQ(transforms.Get(0).Position.x, 13.0f);
+}